@@ -5,12 +5,22 @@
 // later.
 
 /// \file   dense-table.hpp
-/// \brief  Definition of num::dense-table.
+/// \brief  Definition of num::dense_table and num::make_narrow_table().
 
 #ifndef NUMERIC_DENSE_TABLE_HPP
 #define NUMERIC_DENSE_TABLE_HPP
 
-#include <vector> // for vector
+#include <algorithm>   // for max(), min()
+#include <type_traits> // for integral_constant, is_same, is_convertible
+#include <utility>     // for move()
+#include <vector>      // for vector
+
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h> // for vector intrinsics
+#endif
+
+#include <outside.hpp> // for outside::zero
+#include <poly.hpp>    // for is_double_poly, max_abs(), poly
 
 namespace num
 {
@@ -55,6 +65,17 @@ namespace num
    ///
    /// operator()() returns \f$ f_i(a - a_i) \f$.
    ///
+   /// A table of polynomial sub-functions can be made from a function by
+   /// make_dense_interp() or from a sparse_table by make_dense_table().
+   ///
+   /// What is returned outside the domain is determined by the policy \a P
+   /// (see num::outside).  By default, zero is returned.  With
+   /// outside::clamp, outside::extrapolate, or outside::unchecked, the lookup
+   /// has no branch on the domain.
+   ///
+   /// See warped_table for sub-domains spaced logarithmically, and grid_table
+   /// for a function of several arguments on a regular grid.
+   ///
    /// See sparse_table for a piecewise function that can approximate a
    /// function so precisely as dense_table but with fewer sub-functions of the
    /// same type \a F.  The cost of a smaller table in sparse_table is
@@ -62,7 +83,8 @@ namespace num
    ///
    /// \tparam A  Type of function's argument.
    /// \tparam F  Type of each sub-function \f$ f_i \f$ in the table.
-   template <typename A, typename F>
+   /// \tparam P  Policy for argument outside domain.
+   template <typename A, typename F, typename P = outside::zero>
    class dense_table
    {
       /// Type of reciprocal of common difference.
@@ -72,6 +94,8 @@ namespace num
       A da_;             ///< Common difference between subsequent centers.
       I ida_;            ///< Inverse of common difference.
       std::vector<F> f_; ///< Table of sub-functions.
+      A beg_;            ///< Beginning of first sub-domain.
+      A end_;            ///< End of last sub-domain.
 
    public:
       /// Initialize members from a list of arguments.
@@ -91,6 +115,8 @@ namespace num
          if (delta <= A(0)) {
             throw "Length of sub-domain must be positive.";
          }
+         beg_ = a_frst() - 0.5 * da_;
+         end_ = a_last() + 0.5 * da_;
       }
 
       /// Center \f$ a_0 \f$ of first sub-domain.
@@ -111,19 +137,310 @@ namespace num
       /// Find the offset \f$ i \f$ of the sub-domain containing the argument
       /// \f$ a \f$, and return \f$ f_i(a - a_i) \f$.  If \f$ a < a_0 -
       /// \frac{\Delta a}{2} \f$, or \f$ a > a_{n-1} + \frac{\Delta a}{2} \f$,
-      /// then return 0.
+      /// then proceed according to the policy \a P; by default, return 0.
       ///
       /// \return \f$ f_i(a - a_i) \f$.
       R operator()(A const &a /**< Argument to function. */) const
       {
-         if (a < a_frst() - 0.5 * da_ || a > a_last() + 0.5 * da_) {
-            return R(0);
+         if (P::mask && (a < beg_ || a > end_)) {
+            return outside::fill<R>(P());
+         }
+         return eval(outside::arg<P>(a, beg_, end_));
+      }
+
+      /// Evaluate function at each argument in [\a first, \a last), and write
+      /// each result, as by operator()(), to the corresponding element of
+      /// the range beginning at \a out.
+      ///
+      /// The offset of each sub-domain is clamped to the table rather than
+      /// tested, and, if the policy \a P replace the result outside the
+      /// domain, each argument outside the domain is masked after
+      /// evaluation, so the loop has no data-dependent branch.  When \a A is
+      /// double, \a F is poly with double-precision coefficients, and the
+      /// iterators are pointers to double, the loop is vectorized with
+      /// AVX-512, AVX2, or SSE2 intrinsics, according to the instruction set
+      /// for which the code is compiled: the offsets are computed in vector
+      /// registers, and the coefficients are gathered from the table.  (Pass,
+      /// for example, `v.data()` and `v.data() + v.size()` for a
+      /// std::vector.)
+      ///
+      /// \return  Iterator past last result written.
+      template <typename II, typename OI>
+      OI val(
+            /** Iterator to first argument.  */ II first,
+            /** Iterator past last argument. */ II last,
+            /** Iterator to first result.    */ OI out) const
+      {
+         using vec = std::integral_constant<
+               bool, std::is_same<A, double>::value &&
+                           is_double_poly<F>::value &&
+                           std::is_convertible<II, double const *>::value &&
+                           std::is_same<OI, double *>::value>;
+         return batch(first, last, out, vec());
+      }
+
+   private:
+      /// Evaluate sub-function of sub-domain nearest \a a.  Unless the policy
+      /// be outside::unchecked, the offset is clamped to the table; otherwise,
+      /// only the end of the last sub-domain is mapped back onto it.
+      ///
+      /// \return \f$ f_i(a - a_i) \f$.
+      R eval(/** Argument to function. */ A const &a) const
+      {
+         double    u = (a - a_frst()) * ida_ + 0.5;
+         int const m = f_.size() - 1;
+         int       i;
+         if (P::check) {
+            i = std::min(std::max(u, 0.0), double(m));
+         } else {
+            i = std::min(int(u), m);
          }
-         int const i = (a - a_frst()) * ida_ + 0.5;
          A const ai = a_frst() + i * da_;
          return f_[i](a - ai);
       }
+
+      /// Evaluate without branching on the domain.
+      ///
+      /// \return  Same value as operator()() returns.
+      R at(/** Argument to function. */ A const &a) const
+      {
+         R const r = eval(outside::arg<P>(a, beg_, end_));
+         return (P::mask && (a < beg_ || a > end_)) ? outside::fill<R>(P())
+                                                    : r;
+      }
+
+      /// Evaluate at every argument in range, one at a time.
+      ///
+      /// \return  Iterator past last result written.
+      template <typename II, typename OI>
+      OI batch(
+            /** Iterator to first argument.  */ II first,
+            /** Iterator past last argument. */ II last,
+            /** Iterator to first result.    */ OI out,
+            /** Not vectorizable.            */ std::false_type) const
+      {
+         for (; first != last; ++first, ++out) {
+            *out = at(*first);
+         }
+         return out;
+      }
+
+      /// Evaluate at every argument in range, several at a time.
+      ///
+      /// \return  Iterator past last result written.
+      template <typename II, typename OI>
+      OI batch(
+            /** Pointer to first argument.  */ II first,
+            /** Pointer past last argument. */ II last,
+            /** Pointer to first result.    */ OI out,
+            /** Vectorizable.               */ std::true_type) const
+      {
+         double const *x = first;
+         unsigned const n = last - first;
+         unsigned const k = simd(x, n, out, static_cast<F const *>(nullptr));
+         batch(x + k, x + n, out + k, std::false_type());
+         return out + n;
+      }
+
+      /// Evaluate polynomial sub-functions with vector instructions, as many
+      /// arguments at a time as fill a vector register.
+      ///
+      /// \return  Number of arguments evaluated; the rest, fewer than fill a
+      ///          register, are left for the scalar loop.
+      template <unsigned D>
+      unsigned simd(
+            /** Pointer to first argument. */ double const *x,
+            /** Number of arguments.       */ unsigned      n,
+            /** Pointer to first result.   */ double *      y,
+            /** Type of sub-function.      */ poly<D> const *) const
+      {
+         static_assert(sizeof(poly<D>) == (D + 1) * sizeof(double),
+                       "poly must be packed for gather.");
+         unsigned      k = 0;       // Number of arguments evaluated.
+         double const *c = f_[0].c; // Base of coefficients.
+         double const  m = f_.size() - 1;
+         double const  w = outside::fill<double>(P()); // Value when masked.
+#if defined(__AVX512F__)
+         {
+            __m512d const  a0   = _mm512_set1_pd(a_frst_);
+            __m512d const  da   = _mm512_set1_pd(da_);
+            __m512d const  ida  = _mm512_set1_pd(ida_);
+            __m512d const  lo   = _mm512_set1_pd(beg_);
+            __m512d const  hi   = _mm512_set1_pd(end_);
+            __m512d const  half = _mm512_set1_pd(0.5);
+            __m512d const  zero = _mm512_setzero_pd();
+            __m512d const  top  = _mm512_set1_pd(m);
+            __m512d const  fill = _mm512_set1_pd(w);
+            __m256i const  s    = _mm256_set1_epi32(D + 1);
+            for (; k + 8 <= n; k += 8) {
+               __m512d a = _mm512_loadu_pd(x + k);
+               if (P::clip) {
+                  a = _mm512_min_pd(_mm512_max_pd(a, lo), hi);
+               }
+               __mmask8 const in =
+                     _mm512_cmp_pd_mask(a, lo, _CMP_GE_OQ) &
+                     _mm512_cmp_pd_mask(a, hi, _CMP_LE_OQ);
+               __m512d u = _mm512_add_pd(
+                     _mm512_mul_pd(_mm512_sub_pd(a, a0), ida), half);
+               u = _mm512_min_pd(_mm512_max_pd(u, zero), top);
+               u = _mm512_roundscale_pd(u, _MM_FROUND_TO_ZERO);
+               __m512d const t =
+                     _mm512_sub_pd(a, _mm512_add_pd(a0, _mm512_mul_pd(u, da)));
+               __m256i const o =
+                     _mm256_mullo_epi32(_mm512_cvttpd_epi32(u), s);
+               __m512d r = _mm512_mask_i32gather_pd(
+                     zero, 0xff, _mm256_add_epi32(o, _mm256_set1_epi32(D)), c,
+                     8);
+               for (unsigned j = D; j > 0; --j) {
+                  __m512d const cj = _mm512_mask_i32gather_pd(
+                        zero, 0xff,
+                        _mm256_add_epi32(o, _mm256_set1_epi32(j - 1)), c, 8);
+                  r = _mm512_add_pd(_mm512_mul_pd(r, t), cj);
+               }
+               if (P::mask) {
+                  r = _mm512_mask_blend_pd(in, fill, r);
+               }
+               _mm512_storeu_pd(y + k, r);
+            }
+         }
+#endif
+#if defined(__AVX2__)
+         {
+            __m256d const a0   = _mm256_set1_pd(a_frst_);
+            __m256d const da   = _mm256_set1_pd(da_);
+            __m256d const ida  = _mm256_set1_pd(ida_);
+            __m256d const lo   = _mm256_set1_pd(beg_);
+            __m256d const hi   = _mm256_set1_pd(end_);
+            __m256d const half = _mm256_set1_pd(0.5);
+            __m256d const zero = _mm256_setzero_pd();
+            __m256d const top  = _mm256_set1_pd(m);
+            __m256d const fill = _mm256_set1_pd(w);
+            __m128i const s    = _mm_set1_epi32(D + 1);
+            __m256d const all  = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+            for (; k + 4 <= n; k += 4) {
+               __m256d a = _mm256_loadu_pd(x + k);
+               if (P::clip) {
+                  a = _mm256_min_pd(_mm256_max_pd(a, lo), hi);
+               }
+               __m256d const in = _mm256_and_pd(
+                     _mm256_cmp_pd(a, lo, _CMP_GE_OQ),
+                     _mm256_cmp_pd(a, hi, _CMP_LE_OQ));
+               __m256d u = _mm256_add_pd(
+                     _mm256_mul_pd(_mm256_sub_pd(a, a0), ida), half);
+               u = _mm256_min_pd(_mm256_max_pd(u, zero), top);
+               u = _mm256_round_pd(u, _MM_FROUND_TO_ZERO);
+               __m256d const t =
+                     _mm256_sub_pd(a, _mm256_add_pd(a0, _mm256_mul_pd(u, da)));
+               __m128i const o = _mm_mullo_epi32(_mm256_cvttpd_epi32(u), s);
+               __m256d       r = _mm256_mask_i32gather_pd(
+                     zero, c, _mm_add_epi32(o, _mm_set1_epi32(D)), all, 8);
+               for (unsigned j = D; j > 0; --j) {
+                  __m256d const cj = _mm256_mask_i32gather_pd(
+                        zero, c, _mm_add_epi32(o, _mm_set1_epi32(j - 1)), all,
+                        8);
+                  r = _mm256_add_pd(_mm256_mul_pd(r, t), cj);
+               }
+               if (P::mask) {
+                  r = _mm256_blendv_pd(fill, r, in);
+               }
+               _mm256_storeu_pd(y + k, r);
+            }
+         }
+#elif defined(__SSE2__)
+         {
+            // SSE2 has no gather, and so coefficients are loaded by lane.
+            __m128d const a0   = _mm_set1_pd(a_frst_);
+            __m128d const da   = _mm_set1_pd(da_);
+            __m128d const ida  = _mm_set1_pd(ida_);
+            __m128d const lo   = _mm_set1_pd(beg_);
+            __m128d const hi   = _mm_set1_pd(end_);
+            __m128d const half = _mm_set1_pd(0.5);
+            __m128d const zero = _mm_setzero_pd();
+            __m128d const top  = _mm_set1_pd(m);
+            __m128d const fill = _mm_set1_pd(w);
+            for (; k + 2 <= n; k += 2) {
+               __m128d a = _mm_loadu_pd(x + k);
+               if (P::clip) {
+                  a = _mm_min_pd(_mm_max_pd(a, lo), hi);
+               }
+               __m128d const in =
+                     _mm_and_pd(_mm_cmpge_pd(a, lo), _mm_cmple_pd(a, hi));
+               __m128d u =
+                     _mm_add_pd(_mm_mul_pd(_mm_sub_pd(a, a0), ida), half);
+               u = _mm_min_pd(_mm_max_pd(u, zero), top);
+               __m128i const i  = _mm_cvttpd_epi32(u);
+               u                = _mm_cvtepi32_pd(i);
+               __m128d const t =
+                     _mm_sub_pd(a, _mm_add_pd(a0, _mm_mul_pd(u, da)));
+               double const *const p0 = c + _mm_cvtsi128_si32(i) * (D + 1);
+               double const *const p1 =
+                     c + _mm_cvtsi128_si32(_mm_shuffle_epi32(i, 1)) * (D + 1);
+               __m128d r = _mm_set_pd(p1[D], p0[D]);
+               for (unsigned j = D; j > 0; --j) {
+                  r = _mm_add_pd(
+                        _mm_mul_pd(r, t), _mm_set_pd(p1[j - 1], p0[j - 1]));
+               }
+               if (P::mask) {
+                  r = _mm_or_pd(_mm_and_pd(in, r), _mm_andnot_pd(in, fill));
+               }
+               _mm_storeu_pd(y + k, r);
+            }
+         }
+#endif
+         return k;
+      }
    };
+
+   /// Copy a dense table of polynomials into one whose coefficients are
+   /// stored in reduced precision, for example float or bfloat16, and report
+   /// the maximum error induced by rounding the coefficients.
+   ///
+   /// The sub-functions of the new table are still evaluated in double
+   /// precision, but the table occupies a half (float) or a quarter
+   /// (bfloat16) as much memory, so that a table too large for cache might
+   /// fit.  Because each difference between an original and a rounded
+   /// sub-function is a polynomial of degree at most three, the maximum
+   /// absolute error over each sub-domain is computed exactly by max_abs()
+   /// rather than estimated from samples.
+   ///
+   /// If \a tol be positive, and if the error exceed it, then an exception is
+   /// thrown.
+   ///
+   /// The new table has the same policy for an argument outside the domain
+   /// as \a t, but the error reported is only over the domain.
+   ///
+   /// \tparam T  Type of each stored coefficient.
+   /// \tparam D  Degree of each sub-function; at most three.
+   /// \tparam P  Policy for argument outside domain.
+   ///
+   /// \return  Dense table with coefficients of type \a T.
+   template <typename T, unsigned D, typename P>
+   dense_table<double, poly<D, T>, P> make_narrow_table(
+         /// Table of double-precision sub-functions.
+         dense_table<double, poly<D>, P> const &t,
+         /// On return, maximum absolute error induced in the function.
+         double &err,
+         /// Tolerance on error, or zero for no check.
+         double tol = 0.0)
+   {
+      static_assert(D <= 3, "make_narrow_table supports degree up to 3.");
+      double const            w = 0.5 * t.da();
+      std::vector<poly<D, T>> f(t.f().size());
+      err = 0.0;
+      for (unsigned i = 0; i < f.size(); ++i) {
+         poly<3> e = poly<3>();
+         for (unsigned k = 0; k <= D; ++k) {
+            f[i].c[k] = T(t.f()[i].c[k]);
+            e.c[k]    = t.f()[i].c[k] - double(f[i].c[k]);
+         }
+         err = std::max(err, max_abs(e, -w, w));
+      }
+      if (tol > 0.0 && err > tol) {
+         throw "Tolerance not met by narrowing.";
+      }
+      return dense_table<double, poly<D, T>, P>(
+            t.a_frst(), t.da(), std::move(f));
+   }
 }
 
 #endif // ndef NUMERIC_DENSE_TABLE_HPP
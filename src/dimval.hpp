@@ -214,7 +214,7 @@ namespace num
 
    // Forward declaration needed to allow a class to declare rk_quad as a
    // friend.
-   template <typename X, typename Y>
+   template <typename X, typename Y, typename T>
    class rk_quad;
 
    template <typename T>
@@ -240,7 +240,7 @@ namespace num
       friend class integral_stats;
 
       /// Allow rk_quad to construct from known MKS quantity.
-      template <typename X, typename Y>
+      template <typename X, typename Y, typename T>
       friend class rk_quad;
 
       /// Allow tiny to construct from known MKS quantity.
@@ -257,7 +257,7 @@ namespace num
       friend class sparse_table;
 
       /// Allow \ref dense_table to call constructor.
-      template <typename A, typename F>
+      template <typename A, typename F, typename P>
       friend class dense_table;
 
       /// Allow integral() to construct from known MKS quantity.
@@ -509,7 +509,7 @@ namespace num
       friend class sparse_table;
 
       /// Allow \ref dense_table to call constructor.
-      template <typename A, typename F>
+      template <typename A, typename F, typename P>
       friend class dense_table;
 
       /// Type of std::function that can be integrated.  A single-argument
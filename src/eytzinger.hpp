@@ -0,0 +1,132 @@
+
+// Copyright 2016-2017  Thomas E. Vaughan
+//
+// This software is distributable under the terms of the GNU LGPL, Version 3 or
+// later.
+
+/// \file   eytzinger.hpp
+/// \brief  Definition of num::eytzinger.
+
+#ifndef NUMERIC_EYTZINGER_HPP
+#define NUMERIC_EYTZINGER_HPP
+
+#include <algorithm> // for min()
+#include <vector>    // for vector
+
+namespace num
+{
+   /// Search index over a sorted list of keys, stored in [Eytzinger
+   /// order](https://arxiv.org/abs/1509.05053) (the order of a breadth-first
+   /// traversal of the implicit binary search tree).
+   ///
+   /// In a sorted array, the first few probes of a binary search land on
+   /// widely separated elements, and so nearly every probe misses the cache.
+   /// In Eytzinger order, the elements visited in the first several levels
+   /// of the tree are adjacent in memory, and the children of an element at
+   /// position \f$k\f$ sit at positions \f$2k\f$ and \f$2k+1\f$.  So the
+   /// descendants a few levels down can be prefetched while the current
+   /// level is compared, and the descent needs no data-dependent branch.
+   ///
+   /// The index stores only keys and their ranks, so it is compact compared
+   /// with the records whose keys it indexes.
+   ///
+   /// \tparam K  Type of key.
+   template <typename K>
+   class eytzinger
+   {
+      std::vector<K>        k_; ///< Keys in Eytzinger order, from offset 1.
+      std::vector<unsigned> r_; ///< Rank in sorted order of each key.
+
+      /// Copy keys into Eytzinger order by in-order traversal of the
+      /// implicit tree rooted at \a k.
+      ///
+      /// \return  Offset of next key to copy from \a s.
+      unsigned fill(
+            /** Sorted keys.               */ std::vector<K> const &s,
+            /** Offset of next sorted key. */ unsigned              i,
+            /** Position in tree.          */ unsigned              k)
+      {
+         if (k < k_.size()) {
+            i     = fill(s, i, 2 * k);
+            k_[k] = s[i];
+            r_[k] = i++;
+            i     = fill(s, i, 2 * k + 1);
+         }
+         return i;
+      }
+
+      /// Undo the final run of right-hand descents, plus the left-hand
+      /// descent that preceded it, in order to recover the position of the
+      /// least key greater than the search argument.
+      ///
+      /// \return  Position in tree, or zero if every key be less than or equal
+      ///          to the search argument.
+      static unsigned backtrack(/** Position past leaf. */ unsigned k)
+      {
+#ifdef __GNUC__
+         return k >> __builtin_ffs(~k);
+#else
+         while (k & 1) {
+            k >>= 1;
+         }
+         return k >> 1;
+#endif
+      }
+
+   public:
+      /// Construct empty index.
+      eytzinger() {}
+
+      /// Construct index from keys sorted in non-decreasing order.
+      explicit eytzinger(/** Sorted keys. */ std::vector<K> const &s)
+         : k_(s.size() + 1), r_(s.size() + 1)
+      {
+         fill(s, 0, 1);
+      }
+
+      /// Number of keys in index.
+      unsigned size() const { return k_.size() ? k_.size() - 1 : 0; }
+
+      /// Number of keys less than or equal to \a a; this is the offset in
+      /// the sorted list that std::upper_bound() would return.
+      ///
+      /// \return  Number of keys less than or equal to \a a.
+      unsigned count(/** Search argument. */ K const &a) const
+      {
+         return count(k_.data(), r_.data(), size(), a);
+      }
+
+      /// Keys in Eytzinger order, from offset 1.  The element at offset 0 is
+      /// unused.
+      std::vector<K> const &keys() const { return k_; }
+
+      /// Rank in sorted order of each key in keys().
+      std::vector<unsigned> const &ranks() const { return r_; }
+
+      /// Search keys stored elsewhere in Eytzinger order, as by count(K
+      /// const&), for example in a memory-mapped file.
+      ///
+      /// \return  Number of keys less than or equal to \a a.
+      static unsigned count(
+            /** Keys, as by keys().   */ K const *       b,
+            /** Ranks, as by ranks(). */ unsigned const *r,
+            /** Number of keys.       */ unsigned        n,
+            /** Search argument.      */ K const &       a)
+      {
+         // Number of keys per typical cache line of 64 bytes.
+         unsigned constexpr line = (sizeof(K) < 64 ? 64 / sizeof(K) : 1);
+         unsigned k              = 1;
+         while (k <= n) {
+#ifdef __GNUC__
+            // Fetch the descendants that fill one line several levels down.
+            __builtin_prefetch(b + std::min(k * line, n));
+#endif
+            k = 2 * k + (b[k] <= a);
+         }
+         k = backtrack(k);
+         return k ? r[k] : n;
+      }
+   };
+}
+
+#endif // ndef NUMERIC_EYTZINGER_HPP
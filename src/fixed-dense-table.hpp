@@ -0,0 +1,123 @@
+
+// Copyright 2016-2017  Thomas E. Vaughan
+//
+// This software is distributable under the terms of the GNU LGPL, Version 3 or
+// later.
+
+/// \file   fixed-dense-table.hpp
+/// \brief  Definition of num::fixed_dense_table.
+
+#ifndef NUMERIC_FIXED_DENSE_TABLE_HPP
+#define NUMERIC_FIXED_DENSE_TABLE_HPP
+
+namespace num
+{
+   /// A dense_table whose number of sub-functions is fixed at compile time,
+   /// and which can be constructed and looked up at compile time.
+   ///
+   /// The sub-functions are stored in an array within the object rather
+   /// than in a std::vector, and the constructor and every member function
+   /// are constexpr.  So a table declared constexpr at namespace scope is
+   /// initialized by the compiler and placed in read-only data; it requires
+   /// neither allocation nor initialization at program start.  Such a table
+   /// might be written by hand, as in
+   ///
+   ///    constexpr fixed_dense_table<double, poly<1>, 3> t(
+   ///          0.0, 1.0, poly<1>{{0, 1}}, poly<1>{{1, 1}}, poly<1>{{2, 1}});
+   ///
+   /// or generated by a script, as units.pl generates units.hpp.
+   ///
+   /// Lookup is the same as in dense_table.  (A built-in array rather than a
+   /// std::array holds the sub-functions, because the const operator[] of
+   /// std::array is not constexpr in C++11.)  For constexpr lookup, \a F
+   /// must be a literal type whose operator() is constexpr, as is the case
+   /// for poly.
+   ///
+   /// \tparam A  Type of function's argument.
+   /// \tparam F  Type of each sub-function \f$ f_i \f$ in the table.
+   /// \tparam N  Number of sub-functions.
+   template <typename A, typename F, unsigned N>
+   class fixed_dense_table
+   {
+      static_assert(N > 0, "fixed_dense_table must have at least one record.");
+
+      /// Type of reciprocal of common difference.
+      using I = decltype(1.0 / A());
+
+      A a_frst_; ///< Center \f$ a_0 \f$ of first sub-domain.
+      A da_;     ///< Common difference between subsequent centers.
+      I ida_;    ///< Inverse of common difference.
+      F f_[N];   ///< Table of sub-functions.
+
+      /// Offset of sub-domain whose center is nearest to \a a, clamped to the
+      /// table.
+      constexpr int offset(/** Argument to function. */ A const &a) const
+      {
+         return clamp(int((a - a_frst_) * ida_ + 0.5));
+      }
+
+      /// Clamp offset \a i to the table.
+      static constexpr int clamp(/** Offset. */ int i)
+      {
+         return i < 0 ? 0 : (i < int(N) ? i : int(N) - 1);
+      }
+
+   public:
+      /// Initialize members from a list of arguments.
+      ///
+      /// \tparam G  Type of each sub-function, convertible to \a F.
+      template <typename... G>
+      constexpr fixed_dense_table(
+            /// Center \f$ a_0 \f$ of first sub-domain.
+            A const &first,
+            /// Common difference \f$ \Delta a \f$.
+            A const &delta,
+            /// Sub-function objects.  The first is interpreted as \f$ f_0
+            /// \f$, the second as \f$ f_1 \f$, etc.
+            G const &... vf)
+         : a_frst_(first),
+           da_(delta > A(0) ? delta
+                            : throw "Length of sub-domain must be positive."),
+           ida_(1.0 / delta),
+           f_{vf...}
+      {
+         static_assert(sizeof...(G) == N, "Need one sub-function per record.");
+      }
+
+      /// Number of sub-functions.
+      static constexpr unsigned size() { return N; }
+
+      /// Center \f$ a_0 \f$ of first sub-domain.
+      constexpr A a_frst() const { return a_frst_; }
+
+      /// Center \f$ a_{n-1} \f$ of last sub-domain.
+      constexpr A a_last() const { return a_frst_ + (N - 1) * da_; }
+
+      /// Common difference \f$ \Delta a \f$ between subsequent centers.
+      constexpr A da() const { return da_; }
+
+      /// Sub-function \f$ f_i \f$.
+      constexpr F const &f(/** Offset of sub-function. */ unsigned i) const
+      {
+         return f_[i];
+      }
+
+      /// Type of value returned by every sub-function.
+      using R = decltype(F()(A()));
+
+      /// Find the offset \f$ i \f$ of the sub-domain containing the argument
+      /// \f$ a \f$, and return \f$ f_i(a - a_i) \f$.  If \f$ a < a_0 -
+      /// \frac{\Delta a}{2} \f$, or \f$ a > a_{n-1} + \frac{\Delta a}{2} \f$,
+      /// then return 0.
+      ///
+      /// \return \f$ f_i(a - a_i) \f$.
+      constexpr R operator()(A const &a /**< Argument to function. */) const
+      {
+         return (a < a_frst_ - 0.5 * da_ || a > a_last() + 0.5 * da_)
+                      ? R(0)
+                      : f_[offset(a)](a - (a_frst_ + offset(a) * da_));
+      }
+   };
+}
+
+#endif // ndef NUMERIC_FIXED_DENSE_TABLE_HPP
@@ -0,0 +1,238 @@
+
+// Copyright 2016-2017  Thomas E. Vaughan
+//
+// This software is distributable under the terms of the GNU LGPL, Version 3 or
+// later.
+
+/// \file   frozen-table.hpp
+/// \brief  Definition of num::frozen_table.
+
+#ifndef NUMERIC_FROZEN_TABLE_HPP
+#define NUMERIC_FROZEN_TABLE_HPP
+
+#include <algorithm> // for is_sorted(), swap()
+#include <vector>    // for vector
+
+#include <eytzinger.hpp>    // for eytzinger
+#include <outside.hpp>      // for outside::arg(), outside::fill()
+#include <poly.hpp>         // for poly
+#include <sparse-table.hpp> // for sparse_table
+
+namespace num
+{
+   /// Immutable, numeric copy of a sparse_table.
+   ///
+   /// Because the reference count in a GiNaC expression is modified without
+   /// synchronization, even a const sparse_table must not be shared among
+   /// threads.  An instance of frozen_table contains no GiNaC object.  It
+   /// holds only doubles, in the same numeric form that sparse_table uses for
+   /// its fast path: the sub-domain boundaries, the Eytzinger index over
+   /// them, the cubic \ref poly for each sub-function, and the cumulative
+   /// integral at each boundary.  Every member function is const and modifies
+   /// no state, and so one instance may be read concurrently by any number of
+   /// threads without a lock.
+   ///
+   /// A frozen_table can be made from any sparse_table whose argument
+   /// converts to double and whose every sub-function is a numeric
+   /// polynomial of degree three or less, as reported by
+   /// sparse_table::has_pol().  Lookup chooses exactly the same sub-function
+   /// as the original table does, and so val() returns exactly the same value
+   /// as sparse_table::val().
+   class frozen_table
+   {
+   public:
+      using piece = poly<3>; ///< Type of numeric sub-function.
+
+   private:
+      std::vector<double> a_;   ///< Center of each sub-domain.
+      std::vector<double> b_;   ///< Boundaries of sub-domains, n+1 of them.
+      std::vector<piece>  pol_; ///< Sub-functions, in offset from center.
+      std::vector<double> cum_; ///< Integral from b_[0] to each boundary.
+      eytzinger<double>   idx_; ///< Index over left boundaries.
+
+      /// Find offset of sub-domain containing \a a, which must lie within the
+      /// domain of the table.
+      ///
+      /// \return  Offset of sub-domain.
+      unsigned find(/** Argument to function. */ double a) const
+      {
+         unsigned const u = idx_.count(a);
+         return u ? u - 1 : 0;
+      }
+
+      /// True if \a a lie outside the domain of the table.
+      bool outside(/** Argument to function. */ double a) const
+      {
+         return a_.size() == 0 || a < b_.front() || a > b_.back();
+      }
+
+      /// Integral from left boundary of sub-domain \a i to \a a.
+      double part(
+            /** Offset of sub-domain. */ unsigned i,
+            /** End of integration.   */ double   a) const
+      {
+         return pol_[i].integral(b_[i] - a_[i], a - a_[i]);
+      }
+
+   public:
+      /// Construct null table.
+      frozen_table() {}
+
+      /// Freeze a copy of \a t.
+      ///
+      /// An exception is thrown if any sub-function of \a t not have numeric
+      /// form.
+      ///
+      /// \tparam A  Type of argument of \a t, which must convert to double.
+      template <typename A>
+      explicit frozen_table(/** Table to freeze. */ sparse_table<A> const &t)
+      {
+         auto const &d = t.dat();
+         if (d.size() == 0) {
+            return;
+         }
+         if (!t.has_pol()) {
+            throw "frozen_table requires numeric polynomial sub-functions.";
+         }
+         unsigned const n = d.size();
+         a_.resize(n);
+         b_.resize(n + 1);
+         pol_ = t.pol();
+         for (unsigned i = 0; i < n; ++i) {
+            a_[i] = d[i].a;
+            b_[i] = d[i].a - 0.5 * d[i].da; // as in sparse_table::left()
+         }
+         b_[n] = d[n - 1].a + 0.5 * d[n - 1].da;
+         idx_  = eytzinger<double>(
+               std::vector<double>(b_.begin(), b_.end() - 1));
+         cum_.resize(n + 1);
+         cum_[0] = 0.0;
+         for (unsigned i = 0; i < n; ++i) {
+            cum_[i + 1] = cum_[i] + part(i, b_[i + 1]);
+         }
+      }
+
+      /// Number of sub-domains.
+      unsigned size() const { return a_.size(); }
+
+      /// Centers of sub-domains.
+      std::vector<double> const &centers() const { return a_; }
+
+      /// Boundaries of sub-domains; there is one more boundary than there are
+      /// sub-domains.
+      std::vector<double> const &bounds() const { return b_; }
+
+      /// Numeric sub-functions, each taking the offset from the center of its
+      /// sub-domain as its argument.
+      std::vector<piece> const &pol() const { return pol_; }
+
+      /// Integral from beginning of domain to each boundary in bounds().
+      std::vector<double> const &cum() const { return cum_; }
+
+      /// Index over left boundaries.
+      eytzinger<double> const &index() const { return idx_; }
+
+      /// Find sub-domain containing \a a, and return value of its
+      /// sub-function.  If \a a lie outside the domain of the table, then
+      /// return 0.
+      ///
+      /// \return  Value of piecewise function at \a a.
+      double val(/** Argument to function. */ double a) const
+      {
+         return val(a, outside::zero());
+      }
+
+      /// Find sub-domain containing \a a, and return value of its
+      /// sub-function.  If \a a lie outside the domain of the table, then
+      /// proceed according to the policy \a P, as for dense_table.  Because
+      /// the search is clamped to the table, only outside::zero and
+      /// outside::nan branch on the domain.  For any other policy, the table
+      /// must not be empty.
+      ///
+      /// \return  Value of piecewise function at \a a.
+      template <typename P>
+      double val(
+            /** Argument to function.  */ double a,
+            /** Policy outside domain. */ P) const
+      {
+         if (P::mask && outside(a)) {
+            return outside::fill<double>(P());
+         }
+         double const   c = outside::arg<P>(a, b_.front(), b_.back());
+         unsigned const i = find(c);
+         return pol_[i](c - a_[i]);
+      }
+
+      /// Same as val().
+      double operator()(/** Argument to function. */ double a) const
+      {
+         return val(a);
+      }
+
+      /// Evaluate function at each argument in [\a first, \a last), and write
+      /// results to \a out, as by sparse_table::val() over a range.
+      ///
+      /// \return  Iterator past last result written.
+      template <typename I, typename O>
+      O val(
+            /** Iterator to first argument. */ I first,
+            /** Iterator past last argument. */ I last,
+            /** Iterator to first result.   */ O out) const
+      {
+         if (!std::is_sorted(first, last)) {
+            for (; first != last; ++first, ++out) {
+               *out = val(*first);
+            }
+            return out;
+         }
+         unsigned const n = a_.size();
+         unsigned       u = 0; // Number of left boundaries at or before a.
+         for (; first != last; ++first, ++out) {
+            double const a = *first;
+            if (outside(a)) {
+               *out = 0.0;
+               continue;
+            }
+            while (u < n && b_[u] <= a) {
+               ++u;
+            }
+            unsigned const i = u ? u - 1 : 0;
+            *out             = pol_[i](a - a_[i]);
+         }
+         return out;
+      }
+
+      /// Integral over the whole domain.
+      ///
+      /// \return  Integral.
+      double integral() const { return cum_.size() ? cum_.back() : 0.0; }
+
+      /// Integral from \a a to \a b, in constant time after two lookups.
+      /// Any part of the interval outside the domain contributes nothing.
+      ///
+      /// \return  Integral.
+      double integral(
+            /** Beg of range. */ double a, /** End of range. */ double b) const
+      {
+         double sign = 1.0;
+         if (a > b) {
+            sign = -1.0;
+            std::swap(a, b);
+         }
+         if (a_.size() == 0 || a > b_.back() || b < b_.front()) {
+            return 0.0;
+         }
+         if (a < b_.front()) {
+            a = b_.front();
+         }
+         if (b > b_.back()) {
+            b = b_.back();
+         }
+         unsigned const ia = find(a);
+         unsigned const ib = find(b);
+         return sign * (cum_[ib] + part(ib, b) - cum_[ia] - part(ia, a));
+      }
+   };
+}
+
+#endif // ndef NUMERIC_FROZEN_TABLE_HPP
@@ -0,0 +1,436 @@
+
+// Copyright 2016-2017  Thomas E. Vaughan
+//
+// This software is distributable under the terms of the GNU LGPL, Version 3 or
+// later.
+
+/// \file   grid-table.hpp
+/// \brief  Definition of num::grid_table and num::make_grid_table().
+
+#ifndef NUMERIC_GRID_TABLE_HPP
+#define NUMERIC_GRID_TABLE_HPP
+
+#include <algorithm>   // for max(), min()
+#include <array>       // for array
+#include <cmath>       // for floor()
+#include <cstddef>     // for size_t
+#include <tuple>       // for get(), tuple, tuple_element
+#include <type_traits> // for integral_constant
+#include <utility>     // for declval(), move()
+#include <vector>      // for vector
+
+#include <util.hpp> // for index_list, make_index_list
+
+namespace num
+{
+   /// A function of several arguments, interpolated in constant time from its
+   /// values at the nodes of a regular grid.
+   ///
+   /// Along axis \f$k\f$, there are \f$n_k\f$ nodes, the first at
+   /// \f$a_{k,0}\f$, and each separated from the next by \f$\Delta a_k\f$.
+   /// The value at every node is stored in one contiguous array, in row-major
+   /// order: the offset of the node with indices \f$(j_0, j_1, \ldots,
+   /// j_{N-1})\f$ is \f$\sum_k j_k s_k\f$, where the stride \f$s_{N-1} = 1\f$
+   /// and \f$s_k = n_{k+1} s_{k+1}\f$.  So a lookup reads from a single array
+   /// rather than chasing a pointer per axis, as a dense_table of dense_table
+   /// objects would.
+   ///
+   /// For each argument \f$a_k\f$, the cell \f$i_k = \lfloor (a_k - a_{k,0})
+   /// / \Delta a_k \rfloor\f$ is found in constant time, exactly as in
+   /// dense_table, except that the cell lies between two nodes rather than
+   /// being centered on one.  The value is then the tensor product of a
+   /// one-dimensional interpolant along each axis:
+   ///
+   /// - For \a D = 1, linear interpolation between the two nodes bounding the
+   ///   cell (bilinear in two dimensions, trilinear in three).
+   ///
+   /// - For \a D = 3, cubic convolution (Catmull-Rom) over the four nodes
+   ///   nearest the cell (bicubic in two dimensions).  In the first and last
+   ///   cell along an axis, the missing node is extrapolated quadratically
+   ///   from the three nearest, so the interpolant reproduces any quadratic
+   ///   exactly, right up to the boundary.  The first derivative is
+   ///   continuous across cells.
+   ///
+   /// If any argument lie outside the range of nodes on its axis, then there
+   /// is no interpolant, and zero is returned, as by dense_table.
+   ///
+   /// Each argument may have a different type, as for example statdim
+   /// quantities of different dimension, or dyndim.  The quotient of the
+   /// offset \f$a_k - a_{k,0}\f$ by \f$\Delta a_k\f$ must convert to double.
+   ///
+   /// \tparam D  Degree of interpolation along each axis: 1 or 3.
+   /// \tparam V  Type of value at each node.
+   /// \tparam A  Type of each argument, one per axis.
+   template <unsigned D, typename V, typename... A>
+   class grid_table
+   {
+      static_assert(D == 1 || D == 3, "grid_table supports degree 1 or 3.");
+      static_assert(sizeof...(A) > 0, "grid_table must have an axis.");
+
+   public:
+      /// Number of axes.
+      static unsigned constexpr N = sizeof...(A);
+
+      /// Number of nodes along each axis that contribute to the value.
+      static unsigned constexpr W = D + 1;
+
+      /// Tuple of arguments.
+      using args = std::tuple<A...>;
+
+      /// Type of argument along axis \a K.
+      template <unsigned K>
+      using arg = typename std::tuple_element<K, args>::type;
+
+   private:
+      /// Offsets of the nodes contributing along every axis.
+      using offsets = std::size_t[N][W];
+
+      /// Weights of the nodes contributing along every axis.
+      using weights = double[N][W];
+
+      args                               a0_;  ///< First node on each axis.
+      args                               da_;  ///< Spacing along each axis.
+      args                               a1_;  ///< Last node on each axis.
+      std::tuple<decltype(1.0 / A())...> ida_; ///< Inverse of spacing.
+      std::array<unsigned, N>            n_;   ///< Nodes along each axis.
+      std::array<std::size_t, N>         s_;   ///< Stride of each axis.
+      std::vector<V>                     v_;   ///< Value at each node.
+
+      /// Weights of linear interpolation at fraction \a t across cell \a i.
+      static void stencil(
+            /** Cell.               */ int        i,
+            /** Fraction of cell.   */ double     t,
+            /** Nodes on axis.      */ unsigned,
+            /** Offsets of nodes.   */ int *      j,
+            /** Weights of nodes.   */ double *   w,
+            /** Linear.             */ std::integral_constant<unsigned, 1>)
+      {
+         j[0] = i;
+         j[1] = i + 1;
+         w[0] = 1.0 - t;
+         w[1] = t;
+      }
+
+      /// Weights of cubic convolution at fraction \a t across cell \a i.  A
+      /// node missing beyond either end is replaced by its quadratic
+      /// extrapolation, \f$3 f_0 - 3 f_1 + f_2\f$, whose weights are folded
+      /// into those of the three nodes from which it is extrapolated.
+      static void stencil(
+            /** Cell.               */ int        i,
+            /** Fraction of cell.   */ double     t,
+            /** Nodes on axis.      */ unsigned   n,
+            /** Offsets of nodes.   */ int *      j,
+            /** Weights of nodes.   */ double *   w,
+            /** Cubic.              */ std::integral_constant<unsigned, 3>)
+      {
+         double const t2 = t * t;
+         double const t3 = t2 * t;
+         w[0]            = 0.5 * (-t3 + 2.0 * t2 - t);
+         w[1]            = 0.5 * (3.0 * t3 - 5.0 * t2 + 2.0);
+         w[2]            = 0.5 * (-3.0 * t3 + 4.0 * t2 + t);
+         w[3]            = 0.5 * (t3 - t2);
+         for (unsigned k = 0; k < 4; ++k) {
+            j[k] = i - 1 + int(k);
+         }
+         if (i == 0) {
+            w[1] += 3.0 * w[0];
+            w[2] -= 3.0 * w[0];
+            w[3] += w[0];
+            w[0] = 0.0;
+            j[0] = 0;
+         }
+         if (i + 2 == int(n)) {
+            w[2] += 3.0 * w[3];
+            w[1] -= 3.0 * w[3];
+            w[0] += w[3];
+            w[3] = 0.0;
+            j[3] = n - 1;
+         }
+      }
+
+      /// Find cell along axis \a K, and compute offset and weight of each
+      /// node contributing to the value.
+      ///
+      /// \return  True only if \a a lie within the range of nodes.
+      template <unsigned K>
+      bool locate(
+            /** Argument along axis. */ arg<K> const &a,
+            /** Offsets of nodes.    */ std::size_t *  o,
+            /** Weights of nodes.    */ double *       w) const
+      {
+         double const u = (a - std::get<K>(a0_)) * std::get<K>(ida_);
+         double const c =
+               std::min(std::max(std::floor(u), 0.0), double(n_[K] - 2));
+         int j[W];
+         stencil(c, u - c, n_[K], j, w, std::integral_constant<unsigned, D>());
+         for (unsigned k = 0; k < W; ++k) {
+            o[k] = j[k] * s_[K];
+         }
+         return !(a < std::get<K>(a0_) || a > std::get<K>(a1_));
+      }
+
+      /// Locate every argument.
+      ///
+      /// \return  True only if every argument lie within range.
+      template <unsigned... K>
+      bool locate(
+            /** Arguments.         */ args const &a,
+            /** Offsets of nodes.  */ offsets &   o,
+            /** Weights of nodes.  */ weights &   w,
+            /** Offsets of axes.   */ index_list<K...>) const
+      {
+         bool const in[] = {locate<K>(std::get<K>(a), o[K], w[K])...};
+         bool       r    = true;
+         for (bool b : in) {
+            r = r && b;
+         }
+         return r;
+      }
+
+      /// Weighted sum of values over the nodes contributing along the last
+      /// axis.
+      ///
+      /// \return  Contribution to the interpolated value.
+      V sum(/** Offsets.        */ offsets const &o,
+            /** Weights.        */ weights const &w,
+            /** Offset of base. */ std::size_t    b,
+            /** Product so far. */ double         p,
+            /// Last axis.
+            std::integral_constant<unsigned, N - 1>) const
+      {
+         V r = (p * w[N - 1][0]) * v_[b + o[N - 1][0]];
+         for (unsigned k = 1; k < W; ++k) {
+            r += (p * w[N - 1][k]) * v_[b + o[N - 1][k]];
+         }
+         return r;
+      }
+
+      /// Weighted sum of values over the nodes contributing along axis \a K
+      /// and every later axis.
+      ///
+      /// \return  Contribution to the interpolated value.
+      template <unsigned K>
+      V sum(/** Offsets.        */ offsets const &o,
+            /** Weights.        */ weights const &w,
+            /** Offset of base. */ std::size_t    b,
+            /** Product so far. */ double         p,
+            /** Axis.           */ std::integral_constant<unsigned, K>) const
+      {
+         using next = std::integral_constant<unsigned, K + 1>;
+         V r        = sum(o, w, b + o[K][0], p * w[K][0], next());
+         for (unsigned k = 1; k < W; ++k) {
+            r += sum(o, w, b + o[K][k], p * w[K][k], next());
+         }
+         return r;
+      }
+
+      /// Evaluate without branching on the domain.
+      ///
+      /// \return  Same value as operator()() returns.
+      V at(/** Arguments. */ args const &a) const
+      {
+         offsets    o;
+         weights    w;
+         bool const in = locate(a, o, w, typename make_index_list<N>::type());
+         V const    r =
+               sum(o, w, 0, 1.0, std::integral_constant<unsigned, 0>());
+         return in ? r : V();
+      }
+
+   public:
+      /// Initialize table from nodes and values.
+      grid_table(
+            /// First node \f$a_{k,0}\f$ along each axis.
+            args const &first,
+            /// Spacing \f$\Delta a_k\f$ along each axis.
+            args const &delta,
+            /// Number \f$n_k\f$ of nodes along each axis.
+            std::array<unsigned, N> const &n,
+            /// Value at each node, in row-major order.
+            std::vector<V> v)
+         : a0_(first), da_(delta), n_(n), v_(std::move(v))
+      {
+         init(typename make_index_list<N>::type());
+      }
+
+      /// Number \f$n_k\f$ of nodes along each axis.
+      std::array<unsigned, N> const &n() const { return n_; }
+
+      /// Stride \f$s_k\f$ of each axis in the array of values.
+      std::array<std::size_t, N> const &strides() const { return s_; }
+
+      /// First node \f$a_{k,0}\f$ along each axis.
+      args const &first() const { return a0_; }
+
+      /// Spacing \f$\Delta a_k\f$ along each axis.
+      args const &delta() const { return da_; }
+
+      /// Last node along each axis.
+      args const &last() const { return a1_; }
+
+      /// Value at each node, in row-major order.
+      std::vector<V> const &v() const { return v_; }
+
+      /// Interpolate function at arguments.  If any argument lie outside the
+      /// range of nodes on its axis, then return 0.
+      ///
+      /// \return  Interpolated value.
+      V operator()(/** Argument along each axis. */ A const &... a) const
+      {
+         return val(args(a...));
+      }
+
+      /// Interpolate function at tuple of arguments, as by operator()().
+      ///
+      /// \return  Interpolated value.
+      V val(/** Arguments. */ args const &a) const
+      {
+         offsets o;
+         weights w;
+         if (!locate(a, o, w, typename make_index_list<N>::type())) {
+            return V();
+         }
+         return sum(o, w, 0, 1.0, std::integral_constant<unsigned, 0>());
+      }
+
+      /// Interpolate function at each tuple of arguments in [\a first, \a
+      /// last), and write each result, as by operator()(), to the
+      /// corresponding element of the range beginning at \a out.
+      ///
+      /// As in dense_table::val(), every cell is clamped to the grid rather
+      /// than tested, and each result outside the domain is masked to zero
+      /// after evaluation, so the loop has no data-dependent branch.
+      ///
+      /// \return  Iterator past last result written.
+      template <typename II, typename OI>
+      OI val(
+            /** Iterator to first tuple.  */ II first,
+            /** Iterator past last tuple. */ II last,
+            /** Iterator to first result. */ OI out) const
+      {
+         for (; first != last; ++first, ++out) {
+            *out = at(*first);
+         }
+         return out;
+      }
+
+   private:
+      /// Check size of grid, and compute strides, last nodes, and inverse
+      /// spacings.
+      template <unsigned... K>
+      void init(/** Offsets of axes. */ index_list<K...>)
+      {
+         std::size_t m = 1;
+         for (unsigned k = N; k-- > 0;) {
+            if (n_[k] < (D == 1 ? 2u : 3u)) {
+               throw "grid_table has too few nodes along axis.";
+            }
+            s_[k] = m;
+            m *= n_[k];
+         }
+         if (v_.size() != m) {
+            throw "grid_table needs one value per node.";
+         }
+         bool const ok[] = {init<K>()...};
+         for (bool b : ok) {
+            if (!b) {
+               throw "Spacing of grid must be positive.";
+            }
+         }
+      }
+
+      /// Compute last node and inverse spacing along axis \a K.
+      ///
+      /// \return  True only if spacing be positive.
+      template <unsigned K>
+      bool init()
+      {
+         std::get<K>(ida_) = 1.0 / std::get<K>(da_);
+         std::get<K>(a1_) =
+               std::get<K>(a0_) + double(n_[K] - 1) * std::get<K>(da_);
+         return std::get<K>(a1_) > std::get<K>(a0_);
+      }
+   };
+
+   /// Node \a j along axis \a K of a grid.
+   ///
+   /// \return  \f$a_{K,0} + j \Delta a_K\f$.
+   template <unsigned K, typename... A>
+   typename std::tuple_element<K, std::tuple<A...>>::type grid_node(
+         /** First node along each axis. */ std::tuple<A...> const &first,
+         /** Spacing along each axis.    */ std::tuple<A...> const &delta,
+         /** Offset of node.             */ unsigned                 j)
+   {
+      return std::get<K>(first) + double(j) * std::get<K>(delta);
+   }
+
+   /// Sample function \a g at every node of a grid.
+   ///
+   /// \return  Value at each node, in row-major order.
+   template <typename G, typename... A, unsigned... K>
+   auto sample_grid(
+         /// Function.
+         G const &g,
+         /// First node along each axis.
+         std::tuple<A...> const &first,
+         /// Spacing along each axis.
+         std::tuple<A...> const &delta,
+         /// Number of nodes along each axis.
+         std::array<unsigned, sizeof...(A)> const &n,
+         /// Offsets of axes.
+         index_list<K...>) -> std::vector<decltype(g(std::declval<A>()...))>
+   {
+      unsigned constexpr N = sizeof...(A);
+      std::size_t m        = 1;
+      for (unsigned k = 0; k < N; ++k) {
+         m *= n[k];
+      }
+      std::vector<decltype(g(std::declval<A>()...))> v;
+      v.reserve(m);
+      std::array<unsigned, N> j = {}; // Index of node along each axis.
+      for (std::size_t i = 0; i < m; ++i) {
+         v.push_back(g(grid_node<K>(first, delta, j[K])...));
+         for (unsigned k = N; k-- > 0;) {
+            if (++j[k] < n[k]) {
+               break;
+            }
+            j[k] = 0;
+         }
+      }
+      return v;
+   }
+
+   /// Make a grid_table by sampling function \a g at every node of a regular
+   /// grid.  For example,
+   ///
+   ///    auto t = make_grid_table<3>(
+   ///          [](double x, double y) { return sin(x) * cos(y); },
+   ///          std::make_tuple(0.0, 0.0), std::make_tuple(0.01, 0.01),
+   ///          {{101, 201}});
+   ///
+   /// makes a bicubic table over \f$[0, 1] \times [0, 2]\f$.
+   ///
+   /// \tparam D  Degree of interpolation along each axis: 1 or 3.
+   /// \tparam G  Type of function, callable with one argument per axis.
+   /// \tparam A  Type of each argument.
+   ///
+   /// \return  Table interpolating \a g.
+   template <unsigned D, typename G, typename... A>
+   auto make_grid_table(
+         /// Function.
+         G const &g,
+         /// First node along each axis.
+         std::tuple<A...> const &first,
+         /// Spacing along each axis.
+         std::tuple<A...> const &delta,
+         /// Number of nodes along each axis.
+         std::array<unsigned, sizeof...(A)> const &n)
+         -> grid_table<D, decltype(g(std::declval<A>()...)), A...>
+   {
+      using list = typename make_index_list<sizeof...(A)>::type;
+      return grid_table<D, decltype(g(std::declval<A>()...)), A...>(
+            first, delta, n, sample_grid(g, first, delta, n, list()));
+   }
+}
+
+#endif // ndef NUMERIC_GRID_TABLE_HPP
@@ -5,12 +5,22 @@
 // later.
 
 /// \file   integral.hpp
-/// \brief  Definition of num::integral().
+/// \brief  Definition of num::integral() and num::par_integral().
 
 #ifndef NUMERIC_INTEGRAL_HPP
 #define NUMERIC_INTEGRAL_HPP
 
-#include <rk.hpp> // for rk_quad
+#include <algorithm>          // for min(), sort()
+#include <condition_variable> // for condition_variable
+#include <exception>          // for exception_ptr, rethrow_exception()
+#include <future>             // for async(), future
+#include <mutex>              // for mutex, unique_lock
+#include <thread>             // for thread::hardware_concurrency()
+#include <utility>            // for declval(), pair
+#include <vector>             // for vector
+
+#include <rk.hpp>   // for rk_quad
+#include <util.hpp> // for ARG, PRD
 
 namespace num
 {
@@ -36,7 +46,7 @@ namespace num
          /** Error tolerance.            */ double              t = 1.0E-06,
          /** Initial guess parameter.    */ unsigned            n = 16)
    {
-      return rk_quad<X, PRD<X,Y>>(f, aa, bb, t, n).def_int();
+      return rk_quad<X, PRD<X, Y>>(f, aa, bb, t, n).def_int();
    }
 
    /// Numerically integrate a function, and return the result.
@@ -61,7 +71,204 @@ namespace num
          /** Error tolerance.                         */ double   t = 1.0E-06,
          /** Initial number of evenly spaced samples. */ unsigned n = 16)
    {
-      return num::integral(std::function<Y(X)>(f), a, b, t, n);
+      return rk_quad<X, PRD<X, Y>>(f, a, b, t, n).def_int();
+   }
+
+   /// Numerically integrate a lambda or other function object, and return
+   /// the result.
+   ///
+   /// Unlike the overload taking std::function, this one passes the object to
+   /// rk_quad by its own type, so that the compiler can inline each call to
+   /// \a f into the Runge-Kutta step, which saves a substantial fraction of
+   /// the run time for a cheap integrand.  The type of argument is deduced
+   /// from the single, non-template operator() of \a f.
+   ///
+   /// \tparam F   Type of function object.
+   /// \tparam X1  Type of lower limit of integration (convertible to
+   ///             argument).
+   /// \tparam X2  Type of upper limit of integration (convertible to
+   ///             argument).
+   /// \return     Numeric integral of function.
+   template <typename F, typename X1, typename X2>
+   auto integral(
+         /** Function to be integrated.               */ F const &f,
+         /** Lower limit of integration.              */ X1       a,
+         /** Upper limit of integration.              */ X2       b,
+         /** Error tolerance.                         */ double   t = 1.0E-06,
+         /** Initial number of evenly spaced samples. */ unsigned n = 16)
+         -> PRD<ARG<F>, decltype(f(std::declval<ARG<F>>()))>
+   {
+      using X = ARG<F>;
+      using Y = decltype(f(std::declval<X>()));
+      return rk_quad<X, PRD<X, Y>>(f, a, b, t, n).def_int();
+   }
+
+   /// Numerically integrate a function object whose type of argument cannot
+   /// be deduced, and return the result.  This is the case when the object
+   /// have more than one operator(), as does an integrand that also evaluates
+   /// a batch of abscissae at once (see rk_quad).  The type of argument must
+   /// be given explicitly, as in `integral<double>(f, a, b)`.
+   ///
+   /// \tparam X   Type of argument to function.
+   /// \tparam F   Type of function object.
+   /// \tparam X1  Type of lower limit of integration (convertible to X).
+   /// \tparam X2  Type of upper limit of integration (convertible to X).
+   /// \return     Numeric integral of function.
+   template <typename X, typename F, typename X1, typename X2>
+   auto integral(
+         /** Function to be integrated.               */ F const &f,
+         /** Lower limit of integration.              */ X1       a,
+         /** Upper limit of integration.              */ X2       b,
+         /** Error tolerance.                         */ double   t = 1.0E-06,
+         /** Initial number of evenly spaced samples. */ unsigned n = 16)
+         -> PRD<X, decltype(f(std::declval<X>()))>
+   {
+      using Y = decltype(f(std::declval<X>()));
+      return rk_quad<X, PRD<X, Y>>(f, a, b, t, n).def_int();
+   }
+
+   /// Numerically integrate a function in parallel, and return the result.
+   ///
+   /// The domain is split into \a m pieces of equal length, and each piece
+   /// is integrated by rk_quad, as by integral().  \a nt threads take the
+   /// pieces from a common queue.  Each piece is allowed at most \a budget
+   /// evaluations of \a f.  A piece that exceeds its budget, because the
+   /// step size has collapsed there, is abandoned and split in half.  The
+   /// halves go back on the queue, so idle threads are drawn toward the hard
+   /// part of the domain.  A piece is split no more than sixteen times.
+   ///
+   /// rk_quad controls the error of each step relative to the value
+   /// accumulated over its own piece.  So each piece is integrated with the
+   /// tolerance \a t, and the pieces share the budget for error in
+   /// proportion to their contributions.  Where \a f change sign, the error
+   /// relative to the total can exceed \a t by the factor of cancellation.
+   ///
+   /// Which pieces are split depends only on \a f and the arguments, never
+   /// on timing, and the integrals over the final pieces are summed in order
+   /// of position.  So the result is the same, bit for bit, whatever the
+   /// number of threads.  \a f must be safe to call from several threads at
+   /// once.  If \a nt be zero, then there is one thread per hardware
+   /// thread.
+   ///
+   /// \tparam F   Type of function.
+   /// \tparam X1  Type of lower limit of integration (convertible to
+   ///             argument).
+   /// \tparam X2  Type of upper limit of integration (convertible to
+   ///             argument).
+   /// \return     Numeric integral of function.
+   template <typename F, typename X1, typename X2>
+   auto par_integral(
+         /** Function to be integrated.       */ F const &f,
+         /** Lower limit of integration.      */ X1       aa,
+         /** Upper limit of integration.      */ X2       bb,
+         /** Error tolerance.                 */ double   t = 1.0E-06,
+         /** Number of threads.               */ unsigned nt = 0,
+         /** Initial number of pieces.        */ unsigned m = 64,
+         /** Most evaluations of f per piece. */ unsigned budget = 4096)
+         -> PRD<ARG<F>, decltype(f(std::declval<ARG<F>>()))>
+   {
+      using X = ARG<F>;
+      using R = decltype(f(std::declval<X>()));
+      using Y = PRD<X, R>;
+      struct piece
+      {
+         X        a; // Beginning.
+         X        b; // End.
+         unsigned d; // Number of times split.
+      };
+      unsigned constexpr max_d = 16;
+      if (m == 0) {
+         m = 1;
+      }
+      if (nt == 0) {
+         nt = std::thread::hardware_concurrency();
+      }
+      nt = std::max(1u, std::min(nt, m));
+      X const                      a = aa;
+      X const                      b = bb;
+      std::vector<piece>           todo; // Pieces not yet integrated.
+      std::vector<std::pair<X, Y>> done; // Beginning and integral of piece.
+      for (unsigned i = m; i-- > 0;) {
+         X const pa = (i == 0 ? a : a + (b - a) * (double(i) / m));
+         X const pb = (i + 1 == m ? b : a + (b - a) * (double(i + 1) / m));
+         todo.push_back({pa, pb, 0});
+      }
+      std::mutex              mx;
+      std::condition_variable cv;
+      unsigned                busy = 0; // Number of pieces in progress.
+      std::exception_ptr      err;      // First exception from a piece.
+      auto                    work = [&]() {
+         std::unique_lock<std::mutex> lk(mx);
+         for (;;) {
+            cv.wait(lk, [&] { return !todo.empty() || busy == 0; });
+            if (todo.empty()) {
+               return;
+            }
+            piece const p = todo.back();
+            todo.pop_back();
+            ++busy;
+            lk.unlock();
+            // Once the budget be spent, return the last value, so that
+            // rk_quad finishes quickly; the result is then discarded.
+            bool const cap  = p.d < max_d;
+            unsigned   ne   = 0; // Number of evaluations.
+            bool       over = false;
+            R          last = R();
+            auto const g    = [&](X const &x) -> R {
+               if (cap && ne == budget) {
+                  over = true;
+                  return last;
+               }
+               ++ne;
+               return last = f(x);
+            };
+            Y                  v = Y();
+            std::exception_ptr e;
+            try {
+               v = rk_quad<X, Y>(g, p.a, p.b, t).def_int();
+            } catch (...) {
+               e = std::current_exception();
+            }
+            lk.lock();
+            if (e) {
+               if (!err) {
+                  err = e;
+               }
+               todo.clear(); // Abandon the rest.
+            } else if (over) {
+               // Split the piece unless another has thrown.
+               if (!err) {
+                  X const c = p.a + 0.5 * (p.b - p.a);
+                  todo.push_back({p.a, c, p.d + 1});
+                  todo.push_back({c, p.b, p.d + 1});
+               }
+            } else {
+               done.push_back({p.a, v});
+            }
+            --busy;
+            cv.notify_all();
+         }
+      };
+      std::vector<std::future<void>> r;
+      for (unsigned k = 1; k < nt; ++k) {
+         r.push_back(std::async(std::launch::async, work));
+      }
+      work(); // The calling thread works, too.
+      for (auto &i : r) {
+         i.get();
+      }
+      if (err) {
+         std::rethrow_exception(err);
+      }
+      using pt = std::pair<X, Y>;
+      std::sort(done.begin(), done.end(), [](pt const &u, pt const &v) {
+         return u.first < v.first;
+      });
+      Y sum = 0.0 * done[0].second;
+      for (pt const &d : done) {
+         sum += d.second;
+      }
+      return sum;
    }
 }
 
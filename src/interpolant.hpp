@@ -6,22 +6,30 @@
 
 /// \file   interpolant.hpp
 ///
-/// \brief  Definition for each of num::make_const_interp() and
-///         num_make_linear_interp().
+/// \brief  Definition for each of num::make_const_interp(),
+///         num_make_linear_interp(), num::make_dense_interp(),
+///         num::make_multi_interp(), and num::make_cheb_interp().
 
 #ifndef NUMERIC_INTERPOLANT_HPP
 #define NUMERIC_INTERPOLANT_HPP
 
-#include <algorithm> // for sort()
-#include <iostream>  // for cerr, endl
-#include <limits>    // for numeric_limits::epsilon()
-#include <memory>    // for unique_ptr
-#include <string>    // for string
-#include <utility>   // for pair
+#include <algorithm>   // for sort()
+#include <array>       // for array
+#include <cstdint>     // for uint64_t
+#include <future>      // for async(), future
+#include <iostream>    // for cerr, endl
+#include <limits>      // for numeric_limits::epsilon()
+#include <memory>      // for unique_ptr
+#include <string>      // for string
+#include <thread>      // for thread::hardware_concurrency()
+#include <type_traits> // for integral_constant
+#include <utility>     // for pair
 
+#include <dense-table.hpp>    // for dense_table
 #include <ilist.hpp>          // for ipoint, ilist
 #include <integral-stats.hpp> // for integral_stats
 #include <interval.hpp>       // for interval and subinterval_stack
+#include <poly.hpp>           // for cheb, multi_poly, poly
 #include <sparse-table.hpp>   // for sparse_table
 
 namespace num
@@ -279,6 +287,388 @@ namespace num
    {
       return make_linear_interp(std::function<Y(X)>(f), aa, bb, t, n, i);
    }
+
+   /// Evaluate function at each of several arguments, spreading the
+   /// evaluations over several threads.  The function must be safe to call
+   /// concurrently.  If any call throw, then the exception is rethrown from
+   /// here after every thread has finished.
+   inline void par_sample(
+         /** Function to sample.                      */
+         std::function<double(double)> const &f,
+         /** Arguments.                               */
+         std::vector<double> const &x,
+         /** Storage for values, as large as \a x.    */
+         std::vector<double> &y,
+         /** Number of threads, or zero for hardware. */
+         unsigned nt)
+   {
+      unsigned constexpr grain = 16; // Least number of samples per thread.
+      unsigned const     n     = x.size();
+      if (nt == 0) {
+         nt = std::thread::hardware_concurrency();
+      }
+      nt = std::min(nt, (n + grain - 1) / grain);
+      if (nt <= 1) {
+         for (unsigned i = 0; i < n; ++i) {
+            y[i] = f(x[i]);
+         }
+         return;
+      }
+      // The calling thread evaluates the first block.
+      auto blk = [&f, &x, &y, n, nt](unsigned k) {
+         // Product of offset and number of samples can exceed 32 bits.
+         unsigned const ib = std::uint64_t(k) * n / nt;
+         unsigned const ie = std::uint64_t(k + 1) * n / nt;
+         for (unsigned i = ib; i < ie; ++i) {
+            y[i] = f(x[i]);
+         }
+      };
+      std::vector<std::future<void>> r;
+      for (unsigned k = 1; k < nt; ++k) {
+         r.push_back(std::async(std::launch::async, blk, k));
+      }
+      blk(0);
+      for (auto &i : r) {
+         i.get();
+      }
+   }
+
+   /// Make piecewise-constant sub-function from samples at spacing \a w.
+   /// Sample \a k is at the left edge of the sub-domain, sample \a k + 1 at
+   /// the center, and sample \a k + 2 at the right edge.
+   ///
+   /// \return  Error at edges of sub-domain.
+   inline double dense_piece(
+         /** Samples.               */ std::vector<double> const &y,
+         /** Offset of left edge.   */ unsigned                   k,
+         /** Half-width of piece.   */ double,
+         /** Storage for piece.     */ poly<0> &p,
+         /** Degree of piece.       */ std::integral_constant<unsigned, 0>)
+   {
+      p.c[0] = y[k + 1];
+      return std::max(std::fabs(y[k] - p.c[0]), std::fabs(y[k + 2] - p.c[0]));
+   }
+
+   /// Make piecewise-linear sub-function from samples at spacing \a w.
+   /// Sample \a k is at the left edge of the sub-domain, sample \a k + 1 at
+   /// the center, and sample \a k + 2 at the right edge.
+   ///
+   /// \return  Error at center of sub-domain.
+   inline double dense_piece(
+         /** Samples.               */ std::vector<double> const &y,
+         /** Offset of left edge.   */ unsigned                   k,
+         /** Half-width of piece.   */ double                     w,
+         /** Storage for piece.     */ poly<1> &                  p,
+         /** Degree of piece.       */ std::integral_constant<unsigned, 1>)
+   {
+      p.c[0] = 0.5 * (y[k] + y[k + 2]);
+      p.c[1] = 0.5 * (y[k + 2] - y[k]) / w;
+      return std::fabs(y[k + 1] - p.c[0]);
+   }
+
+   /// Make piecewise-cubic Hermite sub-function from samples at spacing \a
+   /// w.  Sample \a k is at the left edge of the sub-domain, sample \a k + 1
+   /// at the center, and sample \a k + 2 at the right edge.  The slope at
+   /// each edge is estimated by a difference, centered except at an end of
+   /// the domain.
+   ///
+   /// \return  Error at center of sub-domain.
+   inline double dense_piece(
+         /** Samples.               */ std::vector<double> const &y,
+         /** Offset of left edge.   */ unsigned                   k,
+         /** Half-width of piece.   */ double                     w,
+         /** Storage for piece.     */ poly<3> &                  p,
+         /** Degree of piece.       */ std::integral_constant<unsigned, 3>)
+   {
+      unsigned const m = y.size() - 1; // Offset of last sample.
+      auto slope = [&y, m, w](unsigned j) {
+         if (j == 0) {
+            return (4.0 * y[1] - 3.0 * y[0] - y[2]) / (2.0 * w);
+         }
+         if (j == m) {
+            return (3.0 * y[m] - 4.0 * y[m - 1] + y[m - 2]) / (2.0 * w);
+         }
+         return (y[j + 1] - y[j - 1]) / (2.0 * w);
+      };
+      double const dl = slope(k);
+      double const dr = slope(k + 2);
+      double const mv = 0.5 * (y[k + 2] + y[k]); // Mean value at edges.
+      double const hv = 0.5 * (y[k + 2] - y[k]); // Half-difference of values.
+      double const ms = 0.5 * (dr + dl);         // Mean slope at edges.
+      p.c[2]          = (dr - dl) / (4.0 * w);
+      p.c[0]          = mv - p.c[2] * w * w;
+      p.c[3]          = (ms - hv / w) / (2.0 * w * w);
+      p.c[1]          = hv / w - p.c[3] * w * w;
+      return std::fabs(y[k + 1] - p.c[0]);
+   }
+
+   /// Sample \a M functions on a regular grid, and make, for each
+   /// sub-domain, a piece of type \a P from the sub-functions of degree \a
+   /// D for every function.  The number of sub-domains is doubled, and only
+   /// the new midpoints are sampled, until the tolerance be met for every
+   /// function, each relative to its own greatest absolute value.  This is
+   /// the work shared by make_dense_interp() and make_multi_interp().
+   ///
+   /// \tparam D   Degree of each sub-function: 0, 1, or 3.
+   /// \tparam M   Number of functions.
+   /// \tparam P   Type of piece stored in table.
+   /// \tparam G   Type of function that makes piece from \a M polynomials.
+   /// \param  nm  Name of caller, for warning.
+   /// \param  f   Functions to approximate via interpolation.
+   /// \param  g   Function making piece from array of one poly per output.
+   /// \param  aa  Left edge of domain.
+   /// \param  bb  Right edge of domain.
+   /// \param  t   Fractional tolerance of approximation.
+   /// \param  n   Initial number of sub-domains.
+   /// \param  nt  Number of threads, or zero for one per hardware thread.
+   template <unsigned D, unsigned M, typename P, typename G>
+   dense_table<double, P> dense_refine(
+         char const *nm, std::function<double(double)> const *f, G const &g,
+         double aa, double bb, double t, unsigned n, unsigned nt)
+   {
+      static_assert(D == 0 || D == 1 || D == 3, "Degree must be 0, 1, or 3.");
+      double constexpr eps     = std::numeric_limits<double>::epsilon();
+      double constexpr min_tol = 1000.0 * eps;
+      unsigned constexpr max_n = 1u << 24; // Maximum number of sub-domains.
+      using table              = dense_table<double, P>;
+      if (t <= 0.0) {
+         throw "tolerance not positive";
+      } else if (t < min_tol) {
+         t = min_tol;
+      }
+      if (n == 0) {
+         throw "Must have at least one sub-domain.";
+      }
+      if (aa > bb) {
+         std::swap(aa, bb);
+      }
+      double              w = 0.5 * (bb - aa) / n; // Spacing of samples.
+      std::vector<double> x(2 * n + 1);            // Arguments of samples.
+      std::vector<std::vector<double>> y(M);       // Values of samples.
+      for (unsigned k = 0; k < x.size(); ++k) {
+         x[k] = aa + k * w;
+      }
+      for (unsigned m = 0; m < M; ++m) {
+         y[m].resize(x.size());
+         par_sample(f[m], x, y[m], nt);
+      }
+      using deg = std::integral_constant<unsigned, D>;
+      for (;;) {
+         // Check tolerance with pieces of half-width w.
+         std::vector<P> vf(n);
+         double         worst = 0.0; // Greatest ratio of error to tolerance.
+         double         err[M], big[M];
+         for (unsigned m = 0; m < M; ++m) {
+            err[m] = big[m] = 0.0;
+            for (double v : y[m]) {
+               big[m] = std::max(big[m], std::fabs(v));
+            }
+         }
+         for (unsigned j = 0; j < n; ++j) {
+            poly<D> p[M];
+            for (unsigned m = 0; m < M; ++m) {
+               double const e = dense_piece(y[m], 2 * j, w, p[m], deg());
+               err[m]         = std::max(err[m], e);
+            }
+            vf[j] = g(p);
+         }
+         for (unsigned m = 0; m < M; ++m) {
+            if (err[m] > t * big[m]) {
+               worst = std::max(worst, err[m] / big[m]);
+            }
+         }
+         if (worst == 0.0) {
+            return table(aa + w, 2.0 * w, std::move(vf));
+         }
+         if (2 * n > max_n) {
+            std::cerr << nm << ": WARNING: Estimated error " << worst
+                      << " is greater than tolerance " << t << "."
+                      << std::endl;
+            return table(aa + w, 2.0 * w, std::move(vf));
+         }
+         // Sample new midpoints, and interleave them with old samples.
+         std::vector<double> xm(2 * n);
+         for (unsigned k = 0; k < xm.size(); ++k) {
+            xm[k] = aa + (2 * k + 1) * (0.5 * w);
+         }
+         for (unsigned m = 0; m < M; ++m) {
+            std::vector<double> ym(2 * n);
+            par_sample(f[m], xm, ym, nt);
+            std::vector<double> yy(4 * n + 1);
+            for (unsigned k = 0; k < xm.size(); ++k) {
+               yy[2 * k]     = y[m][k];
+               yy[2 * k + 1] = ym[k];
+            }
+            yy[4 * n] = y[m][2 * n];
+            y[m]      = std::move(yy);
+         }
+         n *= 2;
+         w *= 0.5;
+      }
+   }
+
+   /// Construct a (\ref dense_table) interpolant for a continuous function
+   /// over the specified interval of its domain.  The table has constant
+   /// (\a D = 0), linear (\a D = 1), or cubic-Hermite (\a D = 3)
+   /// sub-functions, each taking the offset from the center of its
+   /// sub-domain, and so it can be evaluated by dense_table::val() with
+   /// vector instructions.
+   ///
+   /// The function is sampled on a regular grid whose spacing is half the
+   /// length of a sub-domain, so that there is a sample at each edge and at
+   /// each center.  Each sub-function is made from the samples at the edges
+   /// (for a constant, at the center), and the sample not used is compared
+   /// with the sub-function to estimate the error.  If the greatest error
+   /// exceed the fractional tolerance \a t times the greatest absolute value
+   /// sampled, then the number of sub-domains is doubled, and only the new
+   /// midpoints are sampled.  Once the tolerance is met, the table is
+   /// returned.
+   ///
+   /// The samples at each level are evaluated in parallel over \a nt
+   /// threads, and so \a f must be safe to call concurrently.
+   ///
+   /// \tparam D   Degree of each sub-function: 0, 1, or 3.
+   /// \param  f   Function to approximate via interpolation.
+   /// \param  aa  Left edge of domain.
+   /// \param  bb  Right edge of domain.
+   /// \param  t   Fractional tolerance of approximation.
+   /// \param  n   Initial number of sub-domains.
+   /// \param  nt  Number of threads, or zero for one per hardware thread.
+   template <unsigned D>
+   dense_table<double, poly<D>> make_dense_interp(
+         std::function<double(double)> f, double aa, double bb,
+         double t = 1.0E-06, unsigned n = 16, unsigned nt = 0)
+   {
+      auto const g = [](poly<D> const *p) { return p[0]; };
+      return dense_refine<D, 1, poly<D>>(
+            "make_dense_interp", &f, g, aa, bb, t, n, nt);
+   }
+
+   /// Construct a (\ref dense_table) interpolant for several continuous
+   /// functions of the same argument, so that one lookup yields the value of
+   /// every function.  Each sub-function is a multi_poly, whose
+   /// coefficients for every output are stored together.
+   ///
+   /// The functions are sampled, and each output's sub-functions are made,
+   /// exactly as by make_dense_interp(), but the number of sub-domains is
+   /// doubled until the tolerance be met for every function, each relative
+   /// to its own greatest absolute value.
+   ///
+   /// \tparam D   Degree of each sub-function: 0, 1, or 3.
+   /// \tparam M   Number of functions.
+   /// \param  f   Functions to approximate via interpolation.
+   /// \param  aa  Left edge of domain.
+   /// \param  bb  Right edge of domain.
+   /// \param  t   Fractional tolerance of approximation.
+   /// \param  n   Initial number of sub-domains.
+   /// \param  nt  Number of threads, or zero for one per hardware thread.
+   template <unsigned D, unsigned M>
+   dense_table<double, multi_poly<D, M>> make_multi_interp(
+         std::array<std::function<double(double)>, M> const &f, double aa,
+         double bb, double t = 1.0E-06, unsigned n = 16, unsigned nt = 0)
+   {
+      auto const g = [](poly<D> const *p) {
+         return multi_poly<D, M>::gather(p);
+      };
+      return dense_refine<D, M, multi_poly<D, M>>(
+            "make_multi_interp", f.data(), g, aa, bb, t, n, nt);
+   }
+
+   /// Construct a (\ref dense_table) interpolant, whose every sub-function
+   /// is a Chebyshev series (\ref cheb) of degree \a D, for a smooth
+   /// function over the specified interval of its domain.
+   ///
+   /// On each sub-domain, the function is sampled at the \f$D + 1\f$
+   /// Chebyshev nodes, and the interpolating series is made by
+   /// cheb::fit().  The error is estimated at the \f$D + 2\f$ extrema of
+   /// \f$T_{D+1}\f$ on the sub-domain, where the error of the interpolant
+   /// peaks.  If the greatest error exceed the fractional tolerance \a t
+   /// times the greatest absolute value sampled, then the number of
+   /// sub-domains is doubled.  For a smooth function, the error falls as the
+   /// power \f$D + 1\f$ of the length of a sub-domain, so a tolerance near
+   /// machine precision is met by far fewer sub-domains than
+   /// make_dense_interp() needs.
+   ///
+   /// The samples are evaluated in parallel over \a nt threads, and so \a f
+   /// must be safe to call concurrently.
+   ///
+   /// \tparam D   Degree of each sub-function.
+   /// \param  f   Function to approximate via interpolation.
+   /// \param  aa  Left edge of domain.
+   /// \param  bb  Right edge of domain.
+   /// \param  t   Fractional tolerance of approximation.
+   /// \param  n   Initial number of sub-domains.
+   /// \param  nt  Number of threads, or zero for one per hardware thread.
+   template <unsigned D>
+   dense_table<double, cheb<D>> make_cheb_interp(
+         std::function<double(double)> f, double aa, double bb,
+         double t = 1.0E-10, unsigned n = 16, unsigned nt = 0)
+   {
+      double constexpr eps     = std::numeric_limits<double>::epsilon();
+      double constexpr min_tol = 100.0 * eps;
+      unsigned constexpr max_n = 1u << 24; // Maximum number of sub-domains.
+      double constexpr pi      = 3.14159265358979323846;
+      if (t <= 0.0) {
+         throw "tolerance not positive";
+      } else if (t < min_tol) {
+         t = min_tol;
+      }
+      if (n == 0) {
+         throw "Must have at least one sub-domain.";
+      }
+      if (aa > bb) {
+         std::swap(aa, bb);
+      }
+      // Abscissae in [-1, +1] of nodes and of extrema of T_{D+1}.
+      double z[D + 1], e[D + 2];
+      for (unsigned k = 0; k <= D; ++k) {
+         z[k] = cheb<D>::node(k);
+      }
+      for (unsigned k = 0; k <= D + 1; ++k) {
+         e[k] = std::cos(pi * k / (D + 1));
+      }
+      for (;; n *= 2) {
+         double const        h = (bb - aa) / n; // Length of sub-domain.
+         std::vector<double> x(n * (2 * D + 3));
+         std::vector<double> y(x.size());
+         for (unsigned j = 0; j < n; ++j) {
+            double const c  = aa + (j + 0.5) * h;
+            double *     xj = &x[j * (2 * D + 3)];
+            for (unsigned k = 0; k <= D; ++k) {
+               xj[k] = c + 0.5 * h * z[k];
+            }
+            for (unsigned k = 0; k <= D + 1; ++k) {
+               xj[D + 1 + k] = c + 0.5 * h * e[k];
+            }
+         }
+         par_sample(f, x, y, nt);
+         std::vector<cheb<D>> vf(n);
+         double               err = 0.0; // Greatest error.
+         double               big = 0.0; // Greatest absolute value.
+         for (unsigned j = 0; j < n; ++j) {
+            double const *yj = &y[j * (2 * D + 3)];
+            vf[j]            = cheb<D>::fit(yj, h);
+            for (unsigned k = 0; k <= D + 1; ++k) {
+               double const v = yj[D + 1 + k];
+               err = std::max(err, std::fabs(vf[j](0.5 * h * e[k]) - v));
+            }
+         }
+         for (double v : y) {
+            big = std::max(big, std::fabs(v));
+         }
+         if (err <= t * big) {
+            return dense_table<double, cheb<D>>(
+                  aa + 0.5 * h, h, std::move(vf));
+         }
+         if (2 * n > max_n) {
+            std::cerr << "make_cheb_interp: WARNING: Estimated error "
+                      << err / big << " is greater than tolerance " << t
+                      << "." << std::endl;
+            return dense_table<double, cheb<D>>(
+                  aa + 0.5 * h, h, std::move(vf));
+         }
+      }
+   }
 }
 
 #endif // ndef NUMERIC_INTERPOLANT_HPP
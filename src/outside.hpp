@@ -0,0 +1,139 @@
+
+// Copyright 2016-2017  Thomas E. Vaughan
+//
+// This software is distributable under the terms of the GNU LGPL, Version 3 or
+// later.
+
+/// \file   outside.hpp
+/// \brief  Definition of policies in num::outside for lookup outside the
+///         domain of a table.
+
+#ifndef NUMERIC_OUTSIDE_HPP
+#define NUMERIC_OUTSIDE_HPP
+
+#include <limits>      // for numeric_limits
+#include <type_traits> // for integral_constant
+
+namespace num
+{
+   /// Policies that determine what a table returns for an argument outside
+   /// its domain.
+   ///
+   /// Each policy is a tag type, passed either as a template argument (to
+   /// dense_table) or as an argument (to frozen_table::val() and
+   /// sparse_table::val()).  Each has three compile-time properties:
+   ///
+   /// - \a clip: the argument is first clamped to the domain;
+   /// - \a mask: a result outside the domain is replaced by fill();
+   /// - \a check: the offset of the sub-domain is clamped to the table.
+   ///
+   /// Because the properties are constants, a lookup with a policy that
+   /// neither masks nor checks anything compiles to code without a branch
+   /// on the domain.
+   namespace outside
+   {
+      /// Return zero outside the domain.  This is the default, and it costs
+      /// two comparisons and a branch per lookup.
+      struct zero
+      {
+         static bool constexpr clip  = false; ///< Do not clamp argument.
+         static bool constexpr mask  = true;  ///< Replace result.
+         static bool constexpr check = true;  ///< Clamp offset.
+      };
+
+      /// Return NaN outside the domain, so that an argument out of range
+      /// cannot go unnoticed.
+      struct nan
+      {
+         static bool constexpr clip  = false; ///< Do not clamp argument.
+         static bool constexpr mask  = true;  ///< Replace result.
+         static bool constexpr check = true;  ///< Clamp offset.
+      };
+
+      /// Clamp the argument to the domain, and so return the value at the
+      /// nearer end.  Branch-free.
+      struct clamp
+      {
+         static bool constexpr clip  = true;  ///< Clamp argument.
+         static bool constexpr mask  = false; ///< Do not replace result.
+         static bool constexpr check = true;  ///< Clamp offset.
+      };
+
+      /// Evaluate the sub-function at the nearer end of the table, at the
+      /// argument as given.  Branch-free.
+      struct extrapolate
+      {
+         static bool constexpr clip  = false; ///< Do not clamp argument.
+         static bool constexpr mask  = false; ///< Do not replace result.
+         static bool constexpr check = true;  ///< Clamp offset.
+      };
+
+      /// Assume that the caller has already guaranteed the argument to lie
+      /// within the domain, and do not check.  An argument outside the domain
+      /// has undefined behavior.  Branch-free.
+      struct unchecked
+      {
+         static bool constexpr clip  = false; ///< Do not clamp argument.
+         static bool constexpr mask  = false; ///< Do not replace result.
+         static bool constexpr check = false; ///< Trust offset.
+      };
+
+      /// Value returned outside the domain by a policy that masks.
+      ///
+      /// \return  Zero.
+      template <typename R, typename P>
+      R fill(/** Policy. */ P)
+      {
+         return R();
+      }
+
+      /// Value returned outside the domain by outside::nan.
+      ///
+      /// \return  NaN.
+      template <typename R>
+      R fill(/** Policy. */ nan)
+      {
+         return R(std::numeric_limits<double>::quiet_NaN());
+      }
+
+      /// Argument as given, for a policy that does not clip.
+      ///
+      /// \return  \a a.
+      template <typename A>
+      A const &arg(
+            /** Argument.      */ A const &a,
+            /** Beg of domain. */ A const &,
+            /** End of domain. */ A const &,
+            /** Do not clip.   */ std::false_type)
+      {
+         return a;
+      }
+
+      /// Argument clamped to domain, for a policy that clips.
+      ///
+      /// \return  Nearest point of domain to \a a.
+      template <typename A>
+      A const &arg(
+            /** Argument.      */ A const &a,
+            /** Beg of domain. */ A const &lo,
+            /** End of domain. */ A const &hi,
+            /** Clip.          */ std::true_type)
+      {
+         return a < lo ? lo : (hi < a ? hi : a);
+      }
+
+      /// Argument as modified by policy \a P.
+      ///
+      /// \return  \a a, or the nearest point of the domain to \a a.
+      template <typename P, typename A>
+      A const &arg(
+            /** Argument.      */ A const &a,
+            /** Beg of domain. */ A const &lo,
+            /** End of domain. */ A const &hi)
+      {
+         return arg(a, lo, hi, std::integral_constant<bool, P::clip>());
+      }
+   }
+}
+
+#endif // ndef NUMERIC_OUTSIDE_HPP
@@ -0,0 +1,393 @@
+
+// Copyright 2016-2017  Thomas E. Vaughan
+//
+// This software is distributable under the terms of the GNU LGPL, Version 3 or
+// later.
+
+/// \file   poly.hpp
+/// \brief  Definition of num::poly, num::cheb, num::multi_poly,
+///         num::cheb_cubic(), and num::max_abs().
+
+#ifndef NUMERIC_POLY_HPP
+#define NUMERIC_POLY_HPP
+
+#include <algorithm>   // for max()
+#include <array>       // for array
+#include <cmath>       // for cos(), fabs(), sqrt()
+#include <cstdint>     // for uint16_t, uint32_t
+#include <cstring>     // for memcpy()
+#include <type_traits> // for false_type, true_type
+
+namespace num
+{
+   /// Step in Horner's method for poly, written recursively so that the
+   /// evaluation can be constexpr under C++11.
+   ///
+   /// \tparam D  Maximum degree of polynomial.
+   /// \tparam K  Degree of coefficient added at this step.
+   template <unsigned D, unsigned K>
+   struct horner
+   {
+      /// \return \f$ \sum_{k=K}^D c_k t^{k-K} \f$.
+      template <typename T>
+      static constexpr double eval(
+            /** Coefficients.       */ T const *c,
+            /** Offset from center. */ double   t)
+      {
+         return double(c[K]) + t * horner<D, K + 1>::eval(c, t);
+      }
+   };
+
+   /// Final step in Horner's method.
+   template <unsigned D>
+   struct horner<D, D>
+   {
+      /// \return \f$ c_D \f$.
+      template <typename T>
+      static constexpr double eval(T const *c, double)
+      {
+         return double(c[D]);
+      }
+   };
+
+   /// Brain floating-point number, for compact storage of coefficients.
+   ///
+   /// A bfloat16 is the upper half of an IEEE single-precision number: it has
+   /// the same exponent range as float but only eight significant bits, so
+   /// its relative precision is about \f$4 \times 10^{-3}\f$.  It is meant
+   /// only for storage; arithmetic is done in double after conversion.
+   struct bfloat16
+   {
+      uint16_t b; ///< Upper sixteen bits of float.
+
+      /// Leave uninitialized, as for a built-in type.
+      bfloat16() = default;
+
+      /// Round double to nearest bfloat16, ties to even.
+      explicit bfloat16(/** Value. */ double d)
+      {
+         float const f = d;
+         uint32_t    u;
+         std::memcpy(&u, &f, sizeof(u));
+         if ((u & 0x7fffffff) > 0x7f800000) {
+            b = (u >> 16) | 0x0040; // Keep NaN a quiet NaN.
+         } else {
+            b = (u + 0x7fff + ((u >> 16) & 1)) >> 16;
+         }
+      }
+
+      /// Convert to double exactly.
+      operator double() const
+      {
+         uint32_t const u = uint32_t(b) << 16;
+         float          f;
+         std::memcpy(&f, &u, sizeof(f));
+         return f;
+      }
+   };
+
+   /// Polynomial of degree at most \a D.
+   ///
+   /// An instance of poly is meant to serve as a numeric sub-function in a
+   /// piecewise function.  The argument \f$t\f$ passed to the polynomial is
+   /// the offset \f$a - a_i\f$ of the function's argument \f$a\f$ from the
+   /// center \f$a_i\f$ of the sub-domain, just as for a sub-function in
+   /// dense_table.  Storing the coefficients relative to the center of the
+   /// sub-domain keeps round-off small even when the sub-domain is far from
+   /// zero.
+   ///
+   /// The coefficients are packed contiguously so that the whole polynomial
+   /// occupies \f$(D + 1)\f$ times the size of \a T; for a cubic with
+   /// double-precision coefficients, that is half of a typical cache line.
+   /// With \a T float or bfloat16, a table of polynomials occupies a half or
+   /// a quarter as much memory, so that more of it fits in cache, but the
+   /// polynomial is still evaluated in double precision.  See
+   /// make_narrow_table().
+   ///
+   /// \tparam D  Maximum degree of polynomial.
+   /// \tparam T  Type of each stored coefficient.
+   template <unsigned D, typename T = double>
+   struct poly
+   {
+      /// Coefficients: \f$c_k\f$ multiplies \f$t^k\f$.
+      T c[D + 1];
+
+      /// Evaluate polynomial by Horner's method.
+      ///
+      /// \return \f$ \sum_{k=0}^D c_k t^k \f$.
+      constexpr double operator()(/** Offset from center. */ double t) const
+      {
+         return horner<D, 0>::eval(c, t);
+      }
+
+      /// Integrate polynomial in closed form by evaluating its
+      /// antiderivative, \f$ \sum_{k=0}^D c_k t^{k+1} / (k+1) \f$, by Horner's
+      /// method at each limit.
+      ///
+      /// \return \f$ \int_{t_1}^{t_2} \sum_{k=0}^D c_k t^k \, dt \f$.
+      double integral(
+            /** Beg of integration. */ double t1,
+            /** End of integration. */ double t2) const
+      {
+         double r1 = double(c[D]) / (D + 1);
+         double r2 = r1;
+         for (unsigned k = D; k > 0; --k) {
+            double const ck = double(c[k - 1]) / k;
+            r1              = r1 * t1 + ck;
+            r2              = r2 * t2 + ck;
+         }
+         return r2 * t2 - r1 * t1;
+      }
+
+      /// Shift origin of argument.
+      ///
+      /// \return  Polynomial \f$q\f$ such that \f$q(t) = p(t + s)\f$, where
+      ///          \f$p\f$ is the present polynomial.
+      poly<D> shift(/** Offset of new origin. */ double s) const
+      {
+         poly<D> q = poly<D>(); // Expand by Horner's method in (t + s).
+         q.c[0]    = c[D];
+         for (unsigned k = D; k > 0; --k) {
+            for (unsigned j = D - k + 1; j > 0; --j) {
+               q.c[j] = q.c[j - 1] + s * q.c[j];
+            }
+            q.c[0] = s * q.c[0] + double(c[k - 1]);
+         }
+         return q;
+      }
+   };
+
+   /// Cubic that interpolates a function at the four Chebyshev nodes of an
+   /// interval.
+   ///
+   /// \tparam G  Type of function, callable with a double.
+   ///
+   /// \return  Cubic taking the offset from the center \a c of the interval.
+   template <typename G>
+   poly<3> cheb_cubic(
+         /** Function.            */ G const &g,
+         /** Center of interval.  */ double   c,
+         /** Length of interval.  */ double   h)
+   {
+      // Interpolate at nodes by Newton's divided differences.
+      double const pi = 3.14159265358979323846;
+      double       x[4], d[4];
+      for (unsigned k = 0; k < 4; ++k) {
+         x[k] = 0.5 * h * std::cos((2 * k + 1) * pi / 8.0);
+         d[k] = g(c + x[k]);
+      }
+      for (unsigned m = 1; m < 4; ++m) {
+         for (unsigned k = 3; k >= m; --k) {
+            d[k] = (d[k] - d[k - 1]) / (x[k] - x[k - m]);
+         }
+      }
+      // Convert Newton form to monomial coefficients.
+      poly<3> q = poly<3>();
+      q.c[0]    = d[3];
+      for (int k = 2; k >= 0; --k) {
+         for (unsigned m = 3 - k; m > 0; --m) {
+            q.c[m] = q.c[m - 1] - x[k] * q.c[m];
+         }
+         q.c[0] = d[k] - x[k] * q.c[0];
+      }
+      return q;
+   }
+
+   /// Maximum absolute value of a cubic over an interval.  The maximum occurs
+   /// either at an end of the interval or at a root of the derivative.
+   ///
+   /// \return  \f$ \max_{t_1 \le t \le t_2} |p(t)| \f$.
+   inline double max_abs(
+         /** Cubic.             */ poly<3> const &p,
+         /** Beg of interval.   */ double         t1,
+         /** End of interval.   */ double         t2)
+   {
+      double m = std::max(std::fabs(p(t1)), std::fabs(p(t2)));
+      // Coefficients of derivative.
+      double const d0 = p.c[1];
+      double const d1 = 2.0 * p.c[2];
+      double const d2 = 3.0 * p.c[3];
+      double       r[2];  // Roots of derivative.
+      unsigned     n = 0; // Number of roots.
+      if (d2 != 0.0) {
+         double const disc = d1 * d1 - 4.0 * d2 * d0;
+         if (disc >= 0.0) {
+            // Avoid cancellation by computing larger root first.
+            double const q = -0.5 * (d1 + (d1 < 0.0 ? -1.0 : 1.0) *
+                                                std::sqrt(disc));
+            if (q != 0.0) {
+               r[n++] = q / d2;
+               r[n++] = d0 / q;
+            } else {
+               r[n++] = 0.0;
+            }
+         }
+      } else if (d1 != 0.0) {
+         r[n++] = -d0 / d1;
+      }
+      for (unsigned k = 0; k < n; ++k) {
+         if (r[k] > t1 && r[k] < t2) {
+            m = std::max(m, std::fabs(p(r[k])));
+         }
+      }
+      return m;
+   }
+
+   /// Chebyshev series of degree at most \a D, for use as a numeric
+   /// sub-function in a piecewise function, in the same way as poly.
+   ///
+   /// The argument \f$t\f$ is the offset from the center of the
+   /// sub-domain.  It is mapped onto \f$x = s t \in [-1, +1]\f$, where
+   /// \f$s\f$ is twice the inverse of the length of the sub-domain, and the
+   /// series \f$\sum_{k=0}^D c_k T_k(x)\f$ is evaluated by Clenshaw's
+   /// recurrence.  Unlike the monomial coefficients of a poly, the
+   /// coefficients of a Chebyshev series stay well conditioned at high
+   /// degree, and so a smooth function can be approximated to near machine
+   /// precision by few pieces of moderate degree.
+   ///
+   /// \tparam D  Maximum degree of series.
+   template <unsigned D>
+   struct cheb
+   {
+      double s;        ///< Scale \f$s\f$ of offset onto \f$[-1, +1]\f$.
+      double c[D + 1]; ///< Coefficients: \f$c_k\f$ multiplies \f$T_k\f$.
+
+      /// Abscissa in \f$[-1, +1]\f$ of Chebyshev node \a k.
+      ///
+      /// \return \f$ \cos(\pi (k + 1/2) / (D + 1)) \f$.
+      static double node(/** Offset of node. */ unsigned k)
+      {
+         double const pi = 3.14159265358979323846;
+         return std::cos(pi * (k + 0.5) / (D + 1));
+      }
+
+      /// Make series interpolating values at the \f$D + 1\f$ nodes, by the
+      /// discrete cosine transform.
+      ///
+      /// \return  Series taking the offset from the center of the
+      ///          sub-domain.
+      static cheb fit(
+            /** Value at each node(). */ double const *y,
+            /** Length of sub-domain. */ double        h)
+      {
+         double const pi = 3.14159265358979323846;
+         cheb         p;
+         p.s = 2.0 / h;
+         for (unsigned j = 0; j <= D; ++j) {
+            double sum = 0.0;
+            for (unsigned k = 0; k <= D; ++k) {
+               sum += y[k] * std::cos(pi * j * (k + 0.5) / (D + 1));
+            }
+            p.c[j] = (j ? 2.0 : 1.0) * sum / (D + 1);
+         }
+         return p;
+      }
+
+      /// Evaluate series by Clenshaw's recurrence.
+      ///
+      /// \return \f$ \sum_{k=0}^D c_k T_k(s t) \f$.
+      double operator()(/** Offset from center. */ double t) const
+      {
+         double const x  = s * t;
+         double const x2 = 2.0 * x;
+         double       b1 = 0.0;
+         double       b2 = 0.0;
+         for (unsigned k = D; k > 0; --k) {
+            double const b0 = c[k] + x2 * b1 - b2;
+            b2              = b1;
+            b1              = b0;
+         }
+         return c[0] + x * b1 - b2;
+      }
+   };
+
+   /// Several polynomials of degree at most \a D, one per output of a
+   /// vector-valued function, for use as a numeric sub-function in a
+   /// piecewise function, in the same way as poly.
+   ///
+   /// The coefficients of the same degree for every output are stored
+   /// contiguously (structure of arrays within the piece), so that one
+   /// lookup in a table of multi_poly finds the coefficients of every output
+   /// together, in one or a few cache lines, and Horner's method proceeds for
+   /// all outputs at once, in a loop over outputs that the compiler can
+   /// vectorize.  Several properties tabulated against the same argument can
+   /// thus be found by one index computation rather than one per property.
+   ///
+   /// \tparam D  Maximum degree of each polynomial.
+   /// \tparam M  Number of outputs.
+   template <unsigned D, unsigned M>
+   struct multi_poly
+   {
+      /// Coefficients: \f$c_{k,m}\f$ multiplies \f$t^k\f$ in output \f$m\f$.
+      double c[D + 1][M];
+
+      /// Gather polynomials for every output into one piece.
+      ///
+      /// \return  Piece whose output \a m is \a p[m].
+      static multi_poly gather(/** One per output. */ poly<D> const *p)
+      {
+         multi_poly q;
+         for (unsigned k = 0; k <= D; ++k) {
+            for (unsigned m = 0; m < M; ++m) {
+               q.c[k][m] = p[m].c[k];
+            }
+         }
+         return q;
+      }
+
+      /// Polynomial for output \a m.
+      poly<D> out(/** Offset of output. */ unsigned m) const
+      {
+         poly<D> p;
+         for (unsigned k = 0; k <= D; ++k) {
+            p.c[k] = c[k][m];
+         }
+         return p;
+      }
+
+      /// Evaluate every polynomial by Horner's method.
+      ///
+      /// \return  Value of each output at \a t.
+      std::array<double, M> operator()(
+            /** Offset from center. */ double t) const
+      {
+         std::array<double, M> r;
+         for (unsigned m = 0; m < M; ++m) {
+            r[m] = c[D][m];
+         }
+         for (unsigned k = D; k > 0; --k) {
+            for (unsigned m = 0; m < M; ++m) {
+               r[m] = r[m] * t + c[k - 1][m];
+            }
+         }
+         return r;
+      }
+   };
+
+   /// Trait whose value is true only if \a F be an instance of poly.
+   template <typename F>
+   struct is_poly : std::false_type
+   {
+   };
+
+   /// Specialization for poly.
+   template <unsigned D, typename T>
+   struct is_poly<poly<D, T>> : std::true_type
+   {
+   };
+
+   /// Trait whose value is true only if \a F be an instance of poly with
+   /// double-precision coefficients.
+   template <typename F>
+   struct is_double_poly : std::false_type
+   {
+   };
+
+   /// Specialization for poly with double-precision coefficients.
+   template <unsigned D>
+   struct is_double_poly<poly<D>> : std::true_type
+   {
+   };
+}
+
+#endif // ndef NUMERIC_POLY_HPP
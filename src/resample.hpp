@@ -0,0 +1,133 @@
+
+// Copyright 2016-2017  Thomas E. Vaughan
+//
+// This software is distributable under the terms of the GNU LGPL, Version 3 or
+// later.
+
+/// \file   resample.hpp
+/// \brief  Definition of num::make_dense_table().
+
+#ifndef NUMERIC_RESAMPLE_HPP
+#define NUMERIC_RESAMPLE_HPP
+
+#include <algorithm> // for max(), min()
+#include <cmath>     // for fabs(), sqrt()
+#include <vector>    // for vector
+
+#include <dense-table.hpp>  // for dense_table
+#include <frozen-table.hpp> // for frozen_table
+#include <poly.hpp>         // for cheb_cubic(), max_abs(), poly
+
+namespace num
+{
+   /// Resample a piecewise-cubic table onto a regular grid, so that the
+   /// function can be looked up in constant time by a dense_table.
+   ///
+   /// The domain of \a t is divided into \f$n\f$ sub-domains of common
+   /// length.  On each, the sub-function is the cubic that interpolates \a t
+   /// at the four Chebyshev nodes of the sub-domain.  Because every
+   /// sub-function of \a t is also a cubic, the difference between the
+   /// resampled function and \a t is computed exactly, over each part of
+   /// each new sub-domain, by max_abs().  Starting from as many sub-domains
+   /// as \a t has, \f$n\f$ is doubled until that difference nowhere exceed
+   /// the tolerance.  So the bound is guaranteed (up to round-off in the
+   /// arithmetic) rather than estimated from samples.
+   ///
+   /// Where \a t has a kink (as every piecewise-linear interpolant does), no
+   /// cubic matches it exactly, and the error falls only in proportion to
+   /// the length of the new sub-domains.  If the tolerance be not met with
+   /// \a max_n sub-domains, then an exception is thrown.
+   ///
+   /// \return  Dense table whose every sub-function takes the offset from
+   ///          the center of its sub-domain.
+   inline dense_table<double, poly<3>> make_dense_table(
+         /// Table to resample.
+         frozen_table const &t,
+         /// Tolerance on the difference from \a t.
+         double tol,
+         /// True if \a tol be relative to the maximum absolute value of \a t.
+         bool rel = false,
+         /// Maximum number of sub-domains.
+         unsigned max_n = 1u << 24)
+   {
+      if (t.size() == 0) {
+         throw "Cannot resample empty table.";
+      }
+      if (tol <= 0.0) {
+         throw "Tolerance must be positive.";
+      }
+      auto const &b   = t.bounds();
+      auto const &c   = t.centers();
+      auto const &p   = t.pol();
+      double const lo = b.front();
+      double const hi = b.back();
+      if (rel) {
+         double fmax = 0.0;
+         for (unsigned i = 0; i < t.size(); ++i) {
+            fmax = std::max(fmax, max_abs(p[i], b[i] - c[i], b[i + 1] - c[i]));
+         }
+         tol *= fmax;
+         if (tol == 0.0) {
+            tol = 1.0; // Function is zero everywhere and so exact.
+         }
+      }
+      for (unsigned n = t.size(); n <= max_n; n *= 2) {
+         double const h   = (hi - lo) / n;
+         double const a0  = lo + 0.5 * h;
+         double       err = 0.0;
+         unsigned     i   = 0; // Offset of first piece overlapping cell.
+         std::vector<poly<3>> f(n);
+         for (unsigned j = 0; j < n && err <= tol; ++j) {
+            double const   aj = a0 + j * h;
+            poly<3> const &q  = f[j] = cheb_cubic(t, aj, h);
+            // Exact error over each piece of t overlapping the cell.
+            double const cl = std::max(lo, aj - 0.5 * h);
+            double const cr = std::min(hi, aj + 0.5 * h);
+            while (i + 1 < t.size() && b[i + 1] <= cl) {
+               ++i;
+            }
+            for (unsigned u = i; u < t.size() && b[u] < cr; ++u) {
+               poly<3> e = p[u].shift(aj - c[u]);
+               for (unsigned k = 0; k < 4; ++k) {
+                  e.c[k] = q.c[k] - e.c[k];
+               }
+               double const t1 = std::max(cl, b[u]) - aj;
+               double const t2 = std::min(cr, b[u + 1]) - aj;
+               err             = std::max(err, max_abs(e, t1, t2));
+            }
+         }
+         if (err <= tol) {
+            return dense_table<double, poly<3>>(a0, h, std::move(f));
+         }
+         if (n > max_n / 2) {
+            break; // Doubling would exceed max_n or overflow.
+         }
+      }
+      throw "Tolerance not met by resampling.";
+   }
+
+   /// Resample a sparse_table onto a regular grid, as by
+   /// make_dense_table(frozen_table const&, double, bool, unsigned).  Every
+   /// sub-function of \a t must be a numeric polynomial of degree three or
+   /// less.
+   ///
+   /// \tparam A  Type of argument of \a t, which must convert to double.
+   ///
+   /// \return  Dense table whose every sub-function takes the offset from
+   ///          the center of its sub-domain.
+   template <typename A>
+   dense_table<double, poly<3>> make_dense_table(
+         /// Table to resample.
+         sparse_table<A> const &t,
+         /// Tolerance on the difference from \a t.
+         double tol,
+         /// True if \a tol be relative to the maximum absolute value of \a t.
+         bool rel = false,
+         /// Maximum number of sub-domains.
+         unsigned max_n = 1u << 24)
+   {
+      return make_dense_table(frozen_table(t), tol, rel, max_n);
+   }
+}
+
+#endif // ndef NUMERIC_RESAMPLE_HPP
@@ -5,72 +5,102 @@
 // later.
 
 /// \file   rk.hpp
-/// \brief  Definition of num::rk_base and num::rk_quad.
+/// \brief  Definition of num::rk_base, num::rk_quad, and num::rk_ode.
 
 #ifndef NUMERIC_RK_HPP
 #define NUMERIC_RK_HPP
 
-#include <cmath>      // for fabs()
-#include <functional> // for function
-#include <limits>     // for numeric_limits
+#include <array>       // for array
+#include <algorithm>   // for max(), swap()
+#include <cmath>       // for fabs()
+#include <functional>  // for function
+#include <limits>      // for numeric_limits
+#include <type_traits> // for integral_constant, is_convertible
+#include <utility>     // for declval()
 
 #include <ilist.hpp>        // for ilist
 #include <sparse-table.hpp> // for sparse_table
-#include <util.hpp>         // for RAT
+#include <tableau.hpp>      // for cash_karp
+#include <util.hpp>         // for always_void, index_list, RAT
 
 namespace num
 {
-   /// Base class for rk_quad and, eventually, for the class implementing the
-   /// general Runge-Kutta integrator.
+   /// Base class for rk_quad and for rk_ode, the general Runge-Kutta
+   /// integrator.  The coefficients of each method are in a Butcher tableau
+   /// (see num::tableau); only the control of stepsize is here.
    class rk_base
    {
    protected:
-      // These constant expressions are used by rk_quad and will also be used
-      // by the general Runge-Kutta integrator, when it is implemented.  There
-      // are more such constants used only by the general integrator.
-      //
       // It might be interesting to see how much slow-down occurs if we
       // implement all calculations via GiNaC's (CLN's) numeric type instead of
       // double.
 
-      /// Fraction of step size to Substep 3.
-      static double constexpr a3 = 0.3;
-
-      /// Fraction of step size to Substep 4.
-      static double constexpr a4 = 0.6;
-
-      /// Fraction of step size to Substep 5.
-      static double constexpr a5 = 1.0;
-
-      /// Fraction of step size to Substep 6.
-      static double constexpr a6 = 0.875;
-
-      /// Weight for derivative at Substep 1.
-      static double constexpr c1 = 37.0 / 378.0;
-
-      /// Weight for derivative at Substep 3.
-      static double constexpr c3 = 250.0 / 621.0;
-
-      /// Weight for derivative at Substep 4.
-      static double constexpr c4 = 125.0 / 594.0;
-
-      /// Weight for derivative at Substep 6.
-      static double constexpr c6 = 512.0 / 1771.0;
-
-      /// Error coefficient at Substep 1.
-      static double constexpr dc1 = c1 - 2825.0 / 27648.0;
-
-      /// Error coefficient at Substep 3.
-      static double constexpr dc3 = c3 - 18575.0 / 48384.0;
+      /// See implementation of `rkqs()` on Paqe 719 in Numerical Recipes in C,
+      /// Second Edition.
+      static double constexpr SAFETY = 0.9;
 
-      /// Error coefficient at Substep 4.
-      static double constexpr dc4 = c4 - 13525.0 / 55296.0;
+      /// Reduce stepsize no more than a factor of 10.
+      ///
+      /// \tparam T  Butcher tableau, whose estimate of error be of order
+      ///            \a T::order.
+      /// \return    New stepsize.
+      template <typename T, typename X>
+      static X reduce_step_size(
+            /** Old stepsize. */ X h, /** Truncation error. */ double err)
+      {
+         // Here, pow() would be num::pow(double, int), which truncates the
+         // exponent.
+         static double constexpr PSHRNK = -1.0 / T::order;
+         X const        htemp           = SAFETY * h * std::pow(err, PSHRNK);
+         X const        tenth           = 0.1 * h;
+         static X const zero            = 0.0 * h;
+         if (h >= zero) {
+            if (htemp > tenth) {
+               h = htemp;
+            } else {
+               h = tenth;
+            }
+         } else {
+            if (htemp < tenth) {
+               h = htemp;
+            } else {
+               h = tenth;
+            }
+         }
+         return h;
+      }
 
-      /// Error coefficient at Substep 5.
-      static double constexpr dc5 = -277.0 / 14336.0;
+      /// Increase stepsize no more than a factor of 5.
+      ///
+      /// \tparam T  Butcher tableau, whose estimate of error be of order
+      ///            \a T::order.
+      /// \return    Estimated next stepsize.
+      template <typename T, typename X>
+      static X grow_step_size(
+            /** Accomplished stepsize. */ X const &h,
+            /** Truncation error.      */ double   err)
+      {
+         static double constexpr PGROW = -1.0 / (T::order + 1);
+         static double const ERRCON    = std::pow(5.0 / SAFETY, 1.0 / PGROW);
+         if (err > ERRCON) {
+            return SAFETY * h * std::pow(err, PGROW);
+         }
+         return 5.0 * h;
+      }
 
-      /// Error coefficient at Substep 6.
-      static double constexpr dc6 = c6 - 0.25;
+      /// Make sure that tolerance is neither negative nor too small.
+      /// \return  Tolerance, raised if necessary to the least allowed.
+      static double check_tol(/** Requested tolerance. */ double tol)
+      {
+         double constexpr eps     = std::numeric_limits<double>::epsilon();
+         double constexpr min_tol = 100.0 * eps;
+         if (tol <= 0.0) {
+            throw "tolerance not positive";
+         } else if (tol < min_tol) {
+            tol = min_tol;
+         }
+         return tol;
+      }
    };
 
    /// General template class holding a tiny value.  Specialization for dyndim
@@ -95,16 +125,180 @@ namespace num
    template <typename T>
    T const tiny<T>::val_(1.0E-300);
 
+   /// Analysis, at compile time, of each stage of tableau \a T for
+   /// quadrature.  See quad_rule.
+   ///
+   /// \tparam T  Butcher tableau.
+   template <typename T>
+   struct quad_stages
+   {
+      /// \return  True if any weight, in \a b or in \a e, of stage \a j be
+      ///          nonzero.
+      static constexpr bool used(
+            /** Offset of stage.       */ unsigned j,
+            /** Offset of row in \a e. */ unsigned k = 0)
+      {
+         return k == T::estimates ? T::b[j] != 0.0
+                                  : T::e[k][j] != 0.0 || used(j, k + 1);
+      }
+
+      /// \return  Offset of first used stage, at or after \a i, whose node
+      ///          is that of stage \a j; or \a j.
+      static constexpr unsigned first(
+            /** Offset of stage.          */ unsigned j,
+            /** Offset of stage to check. */ unsigned i = 0)
+      {
+         return i == j || (used(i) && T::c[i] == T::c[j]) ? i
+                                                           : first(j, i + 1);
+      }
+
+      /// \return  True if stage \a j must be evaluated in the batch, because
+      ///          it be used, its node be nonzero, and no earlier used stage
+      ///          share its node.
+      static constexpr bool fresh(/** Offset of stage. */ unsigned j)
+      {
+         return used(j) && T::c[j] != 0.0 && first(j) == j;
+      }
+
+      /// \return  Number of stages before stage \a j that must be evaluated
+      ///          in the batch.
+      static constexpr unsigned before(/** Offset of stage. */ unsigned j)
+      {
+         return j == 0 ? 0 : before(j - 1) + fresh(j - 1);
+      }
+
+      /// \return  Offset, at or after \a j, of stage for element \a k of
+      ///          batch.
+      static constexpr unsigned nth(
+            /** Offset in batch.               */ unsigned k,
+            /** Offset of first stage to check. */ unsigned j = 0)
+      {
+         return fresh(j) ? (k == 0 ? j : nth(k - 1, j + 1)) : nth(k, j + 1);
+      }
+
+      /// \return  Zero if the node of stage \a j be zero, or else one plus
+      ///          the offset in the batch of the value at its node.
+      static constexpr unsigned slot(/** Offset of stage. */ unsigned j)
+      {
+         return T::c[j] == 0.0 ? 0 : 1 + before(first(j));
+      }
+
+      /// \return  Slot of a used stage, at or after \a j, whose node is at
+      ///          the end of the step, or zero if there be none.
+      static constexpr unsigned end(/** Offset of stage. */ unsigned j = 0)
+      {
+         return j == T::stages
+                      ? 0
+                      : (used(j) && T::c[j] == 1.0 ? slot(j) : end(j + 1));
+      }
+   };
+
+   /// Rule of quadrature derived from tableau \a T.
+   ///
+   /// Because the integrand does not depend on the accumulated variable, the
+   /// value at each stage depends only on its node.  So a stage whose
+   /// weights are all zero (as for the second stage of Cash-Karp) need not
+   /// be evaluated, and stages that share a node (as do the last two of
+   /// DOPRI5) share a value.  The first stage, at node zero, is the value at
+   /// the end of the previous step, and every other needed value is at one
+   /// of \a n distinct nodes \a c, evaluated together in a batch.  If a node
+   /// be at the end of the step, then its value begins the next step, so
+   /// that each step of Cash-Karp costs four evaluations, and each step of
+   /// DOP853 costs seven.
+   ///
+   /// \tparam T  Butcher tableau.
+   template <typename T,
+             typename = typename make_index_list<
+                   quad_stages<T>::before(T::stages)>::type,
+             typename = typename make_index_list<T::stages>::type>
+   struct quad_rule;
+
+   /// Specialization that expands the lists of indices.
+   template <typename T, unsigned... I, unsigned... J>
+   struct quad_rule<T, index_list<I...>, index_list<J...>>
+   {
+      /// Number of nodes in batch.
+      static unsigned constexpr n = sizeof...(I);
+
+      /// One plus offset in batch of node at end of step, or zero.
+      static unsigned constexpr last = quad_stages<T>::end();
+
+      /// Nodes in batch.
+      static double constexpr c[n] = {T::c[quad_stages<T>::nth(I)]...};
+
+      /// For each stage, zero for the first node, or else one plus offset of
+      /// its node in batch.
+      static unsigned constexpr slot[T::stages] = {
+            quad_stages<T>::slot(J)...};
+   };
+
+   template <typename T, unsigned... I, unsigned... J>
+   double constexpr quad_rule<T, index_list<I...>, index_list<J...>>::c[];
+
+   template <typename T, unsigned... I, unsigned... J>
+   unsigned constexpr quad_rule<T, index_list<I...>, index_list<J...>>::slot[];
+
+   /// Number of abscissae in a batch passed to a vectorized integrand by
+   /// rk_quad with the default tableau, Cash-Karp.  This is the number of
+   /// independent stages evaluated in each step.  For another tableau, see
+   /// rk_quad::batch.
+   unsigned constexpr rk_batch = quad_rule<tableau::cash_karp>::n;
+
+   /// Type that is std::true_type only if \a G, besides taking a single
+   /// argument of type \a X, take std::array<X, N> and return something
+   /// convertible to std::array<R, N>.
+   ///
+   /// \tparam G  Type of function to be integrated.
+   /// \tparam X  Type of argument.
+   /// \tparam R  Type returned for a single argument.
+   /// \tparam N  Number of abscissae in batch.
+   template <typename G, typename X, typename R, unsigned N = rk_batch,
+             typename = void>
+   struct takes_batch : std::false_type
+   {
+   };
+
+   /// Specialization for \a G that can be called with a batch.
+   template <typename G, typename X, typename R, unsigned N>
+   struct takes_batch<
+         G, X, R, N,
+         typename always_void<decltype(std::declval<G const &>()(
+               std::declval<std::array<X, N> const &>()))>::type>
+         : std::integral_constant<
+                 bool,
+                 std::is_convertible<
+                       decltype(std::declval<G const &>()(
+                             std::declval<std::array<X, N> const &>())),
+                       std::array<R, N>>::value>
+   {
+   };
+
    /// Runge-Kutta integrator optimized for quadrature.
+   ///
+   /// The method is given by the Butcher tableau \a T.  By default, it is
+   /// the fifth-order method of Cash and Karp; for a smooth integrand at a
+   /// tight tolerance, tableau::dop853 takes far fewer steps.  Because the
+   /// integrand does not depend on the accumulated variable, the stages
+   /// after the first in each step are independent (see quad_rule).  If the
+   /// function to be integrated can also be called with a std::array<X,
+   /// batch> of abscissae, returning an array of values (see takes_batch),
+   /// then those stages are evaluated in one call, so that an integrand
+   /// written with SIMD can compute them together.  An ordinary function is
+   /// evaluated once per stage.
+   ///
    /// \tparam X  Type of the independent variable.
    /// \tparam Y  Type of the variable that is accumulated during
    /// integration.
-   template <typename X, typename Y>
+   /// \tparam T  Butcher tableau.
+   template <typename X, typename Y, typename T = tableau::cash_karp>
    class rk_quad : rk_base
    {
       /// Type returned by function to be integrated.
       using DYDX = RAT<Y, X>;
 
+      /// Rule of quadrature.
+      using Q = quad_rule<T>;
+
    public:
       /// Type of function to be integrated.
       using func = std::function<DYDX(X)>;
@@ -115,10 +309,61 @@ namespace num
       /// Type of list of partial integrations of function.
       using ylist = ilist<X, Y>;
 
+      /// Number of abscissae in a batch passed to a vectorized integrand.
+      static unsigned constexpr batch = Q::n;
+
    private:
-      /// Function to be integrated.  This is called \a deriv because
-      /// Runge-Kutta integrates a derivative.
-      func deriv;
+      /// Abscissae of stages.
+      using nodes = std::array<X, batch>;
+
+      /// Stage values.
+      using stages = std::array<DYDX, batch>;
+
+      /// Abscissa of each stage in batch.
+      ///
+      /// \return  Abscissae.
+      template <unsigned... I>
+      nodes abscissae(/** Length of interval. */ X const &h,
+                      /** Offsets in batch.  */ index_list<I...>) const
+      {
+         return {{(x + Q::c[I] * h)...}};
+      }
+
+      /// Evaluate \a deriv at each abscissa, one at a time.
+      ///
+      /// \return  Value at each abscissa.
+      template <typename G, unsigned... I>
+      static stages eval(
+            /** Function to be integrated. */ G const &    deriv,
+            /** Abscissae.                 */ nodes const &a,
+            /** Offsets in batch.          */ index_list<I...>)
+      {
+         return {{deriv(a[I])...}};
+      }
+
+      /// Evaluate \a deriv at each abscissa, one at a time.
+      ///
+      /// \return  Value at each abscissa.
+      template <typename G>
+      static stages eval(
+            /** Function to be integrated. */ G const &    deriv,
+            /** Abscissae.                 */ nodes const &a,
+            /** Not vectorized.            */ std::false_type)
+      {
+         return eval(deriv, a, typename make_index_list<batch>::type());
+      }
+
+      /// Evaluate \a deriv at every abscissa in one call.
+      ///
+      /// \return  Value at each abscissa.
+      template <typename G>
+      static stages eval(
+            /** Function to be integrated. */ G const &    deriv,
+            /** Abscissae.                 */ nodes const &a,
+            /** Vectorized.                */ std::true_type)
+      {
+         return deriv(a);
+      }
 
       X      x;     ///< Independent variable.
       Y      y;     ///< Variable accumulated during integration.
@@ -130,129 +375,104 @@ namespace num
       int    nok;   ///< Number of propagations with planned h.
       int    nbad;  ///< Number of propagations with unplanned h.
 
+      /// Sum, over stages, of weight times value.  A stage whose weight is
+      /// zero is skipped.
+      ///
+      /// \return  Weighted sum.
+      DYDX sum(/** Weight of each stage. */ double const *w,
+               /** Values in batch.      */ stages const & ak) const
+      {
+         DYDX s = 0.0 * dydx;
+         for (unsigned j = 0; j < T::stages; ++j) {
+            if (w[j] != 0.0) {
+               unsigned const k = Q::slot[j];
+               s                = s + w[j] * (k ? ak[k - 1] : dydx);
+            }
+         }
+         return s;
+      }
+
       /// Given the value for variable \a y and the value for its derivative \a
-      /// dydx, use the fifth-order Cash-Karp Runge-Kutta method to advance the
-      /// solution for \a y over an interval \a h, and return the incremented
-      /// variable as \a yout.  Also, return, by way of the embedded
-      /// fourth-order method, an estimate \a yerr of the local truncation
-      /// error in \a yout.  The supplied function \a deriv returns the
-      /// derivative (just like dydx) at any value of the independent variable.
+      /// dydx, use the method of the tableau to advance the solution for \a y
+      /// over an interval \a h, and return the incremented variable as \a
+      /// out.  Also, return, by way of the embedded method, an estimate of
+      /// the local truncation error, relative to \a yscal.  The supplied
+      /// function \a deriv returns the derivative (just like dydx) at any
+      /// value of the independent variable.
       ///
       /// This function is based on a simplified version of `rkck()` found on
       /// Page 719 in Numerical Recipes in C, Second Edition.  The
       /// simplification is due mainly to the fact that the present function is
       /// used for quadrature, and so \a deriv does not require \a y as input.
       ///
-      void
-      rkck(/** Length of interval.                   */ X const &h,
-           /** Accumulated value at end of interval. */ Y &      out,
-           /** Estimate of local truncation error.   */ Y &      e)
+      /// \tparam G  Type of function to be integrated.
+      /// \return    Ratio of estimated error to \a yscal.
+      template <typename G>
+      double
+      rkck(/** Function to be integrated.            */ G const &deriv,
+           /** Length of interval.                   */ X const &h,
+           /** Scaling used to monitor accuracy.     */ Y const &yscal,
+           /** Values in batch.                      */ stages & ak,
+           /** Accumulated value at end of interval. */ Y &      out)
       {
-         // 1st step is given as dydx on input.
-         // 2nd step not needed because deriv() does not need y as input.
-         X const x3 = x + a3 * h;
-         X const x4 = x + a4 * h;
-         X const x5 = x + a5 * h;
-         X const x6 = x + a6 * h;
-         RAT<Y, X> const ak3 = deriv(x3); // 3rd step.
-         RAT<Y, X> const ak4 = deriv(x4); // 4th step.
-         RAT<Y, X> const ak5 = deriv(x5); // 5th step.
-         RAT<Y, X> const ak6 = deriv(x6); // 6th step.
+         // 1st step is given as dydx on input.  Every other needed step is
+         // independent of the others.
+         nodes const xs =
+               abscissae(h, typename make_index_list<batch>::type());
+         ak             = eval(deriv, xs, takes_batch<G, X, DYDX, batch>());
          // Accumulate increments with proper weights.
-         out = y + h * (c1 * dydx + c3 * ak3 + c4 * ak4 + c6 * ak6);
-         // Estimate eor as difference between fourth- and fifth-order
-         // methods.
-         e = h * (dc1 * dydx + dc3 * ak3 + dc4 * ak4 + dc5 * ak5 + dc6 * ak6);
-      }
-
-      /// See implementation of `rkqs()` on Paqe 719 in Numerical Recipes in C,
-      /// Second Edition.
-      static double constexpr SAFETY = 0.9;
-
-      /// Reduce stepsize no more than a factor of 10.
-      /// \return  New stepsize.
-      static X reduce_step_size(
-            /** Old stepsize. */ X h, /** Truncation error. */ double err)
-      {
-         static double constexpr PSHRNK = -0.25;
-         X const        htemp           = SAFETY * h * pow(err, PSHRNK);
-         X const        tenth           = 0.1 * h;
-         static X const zero            = 0.0 * h;
-         if (h >= zero) {
-            if (htemp > tenth) {
-               h = htemp;
-            } else {
-               h = tenth;
-            }
-         } else {
-            if (htemp < tenth) {
-               h = htemp;
-            } else {
-               h = tenth;
-            }
-         }
-         return h;
+         out = y + h * sum(T::b, ak);
+         // Estimate error as difference between solutions of different
+         // order.
+         auto const r = [&](unsigned k) -> double {
+            return h * sum(T::e[k], ak) / yscal;
+         };
+         return T::error(r);
       }
 
-      /// Fifth-order Runge-Kutta step with monitoring of local truncation
-      /// error to ensure accurcy and adjust stepsize. Input are the
-      /// accumulated variable \a y and its derivative \a dydx at the starting
-      /// value of the independent variable \a x.  Also input are the stepsize
-      /// \a htry to be attempted and the required accuracy \a tol.  On output,
-      /// \a y and \a x are replaced by their new values, \a hdid is the
-      /// stepsize that was actually accomplished, and \a hnext is the
-      /// estimated next stepsize.  The supplied function \a deriv returns the
-      /// derivative (just like dydx) at any value of the independent variable.
+      /// Runge-Kutta step with monitoring of local truncation error to ensure
+      /// accurcy and adjust stepsize. Input are the accumulated variable \a y
+      /// and its derivative \a dydx at the starting value of the independent
+      /// variable \a x.  Also input are the stepsize \a htry to be attempted
+      /// and the required accuracy \a tol.  On output, \a y and \a x are
+      /// replaced by their new values, \a hdid is the stepsize that was
+      /// actually accomplished, and \a hnext is the estimated next stepsize.
+      /// The supplied function \a deriv returns the derivative (just like
+      /// dydx) at any value of the independent variable.
       ///
       /// This function is based on `rkqs()` found on Page 719 in Numerical
       /// Recipes in C, Second Edition.
       ///
+      /// \tparam G  Type of function to be integrated.
+      template <typename G>
       void
-      rkqs(/** Stepsize to be attempted.         */ X const &htry,
+      rkqs(/** Function to be integrated.        */ G const &deriv,
+           /** Stepsize to be attempted.         */ X const &htry,
            /** Scaling used to monitor accuracy. */ Y const &yscal,
+           /** Values in batch of last step.     */ stages & ak,
            /** Stepsize that was accomplished.   */ X &      hdid,
            /** Estimated next stepsize.          */ X &      hnext)
       {
          double err;
-         Y      yerr;
          Y      ytemp;
          X      h = htry; // initial trial value
          while (true) {
-            rkck(h, ytemp, yerr); // Take a trial step.
-            err = fabs(yerr / yscal / tol);
+            // Take a trial step.
+            err = rkck(deriv, h, yscal, ak, ytemp) / tol;
             if (err <= 1.0) {
                break;
             }
             // Truncation error is too large.
-            h = reduce_step_size(h, err);
+            h = reduce_step_size<T>(h, err);
             if (x + h == x) {
                throw "stepsize underflow";
             }
          }
-         // Increase stepsize no more than a factor of 5.
-         static double constexpr PGROW = -0.2;
-         static double const ERRCON    = pow(5.0 / SAFETY, 1.0 / PGROW);
-         if (err > ERRCON) {
-            hnext = SAFETY * h * pow(err, PGROW);
-         } else {
-            hnext = 5.0 * h;
-         }
+         hnext = grow_step_size<T>(h, err);
          x += (hdid = h);
          y = ytemp;
       }
 
-      /// Make sure that tolerance is neither negative nor too small.
-      void check_tol()
-      {
-         double constexpr eps     = std::numeric_limits<double>::epsilon();
-         double constexpr min_tol = 100.0 * eps;
-         if (tol <= 0.0) {
-            throw "tolerance not positive";
-         } else if (tol < min_tol) {
-            tol = min_tol;
-         }
-      }
-
       /// Make sure that n is reasonable, and pick initial guess at stepsize.
       X initial_h(
             /** Lower limit of integration. */ X const &x1,
@@ -272,17 +492,27 @@ namespace num
 
       /// This function is based on `odeint()` on Page 721 of Numerical Recipes
       /// in C, Second Edition.
+      ///
+      /// The function to be integrated is called \a deriv because Runge-Kutta
+      /// integrates a derivative.  It is passed down to rkck() as a template
+      /// argument rather than stored, so that, when its type be a lambda or
+      /// other functor, rather than std::function, each call can be inlined.
+      ///
+      /// \tparam G  Type of function to be integrated.
+      template <typename G>
       void
-      init(/** Lower limit of integration. */ X   x1,
-           /** Upper limit of integration. */ X   x2,
-           /** Number of equal-size steps. */ int n)
+      init(/** Function to be integrated.  */ G const &deriv,
+           /** Lower limit of integration. */ X        x1,
+           /** Upper limit of integration. */ X        x2,
+           /** Number of equal-size steps. */ int      n)
       {
-         check_tol();
+         tol = check_tol(tol);
          X h = initial_h(x1, x2, n);
          using namespace std;
          static const PRD<X, X> XSQR_0 = 0.0 * x1 * x1;
+         stages                  ak;
+         dydx = deriv(x);
          while (true) {
-            dydx = deriv(x);
             // This doesn't work when Y is dyndim.
             static Y const TINY = tiny<Y>::val(dydx * h);
             // General-purpose scaling used to monitor accuracy.
@@ -296,15 +526,22 @@ namespace num
                h = x2 - x; // Decrease stepsize to avoid overshoot.
             }
             X hdid, hnext;
-            rkqs(h, yscal, hdid, hnext);
+            rkqs(deriv, h, yscal, ak, hdid, hnext);
             if (hdid == h) {
                ++nok;
             } else {
                ++nbad;
             }
+            // Value at end of step begins next step.  If the tableau have a
+            // node at the end of the step, then the value is already known.
+            if (Q::last) {
+               dydx = ak[Q::last - 1];
+            } else {
+               dydx = deriv(x);
+            }
             if ((x - x2) * (x2 - x1) >= XSQR_0) {
                if (store) {
-                  dl.push_back({x, deriv(x)});
+                  dl.push_back({x, dydx});
                   yl.push_back({x, y});
                }
                return; // We are done; exit normally.
@@ -323,9 +560,9 @@ namespace num
       typedef DYDX (*cfunc)(X);
 
       /// Numerically integrate a function, and store the result in rk_quad::y.
-      /// Use fifth-order Runge-Kutta with adaptive stepsize for quadrature.
-      /// The initial guess for the step size is used at the lower limit of
-      /// integration.
+      /// Use Runge-Kutta, with tableau \a T and adaptive stepsize, for
+      /// quadrature.  The initial guess for the step size is used at the
+      /// lower limit of integration.
       ///
       /// The optional parameter \a n indicates that the initial step should be
       /// 1/n of the interval of integration.
@@ -344,21 +581,15 @@ namespace num
             /** Error tolerance.                      */ double t = 1.0E-06,
             /** Inverse of initial step size.         */ int    n = 16,
             /** Whether to store intermediate values. */ bool   s = false)
-         : deriv(f)
-         , x(x1)
-         , y(0 * x * f(x1))
-         , tol(t)
-         , store(s)
-         , nok(0)
-         , nbad(0)
+         : x(x1), y(0 * x * f(x1)), tol(t), store(s), nok(0), nbad(0)
       {
-         init(x1, x2, n);
+         init(f, x1, x2, n);
       }
 
       /// Numerically integrate a function, and store the result in rk_quad::y.
-      /// Use fifth-order Runge-Kutta with adaptive stepsize for quadrature.
-      /// The initial guess for the step size is used at the lower limit of
-      /// integration.
+      /// Use Runge-Kutta, with tableau \a T and adaptive stepsize, for
+      /// quadrature.  The initial guess for the step size is used at the
+      /// lower limit of integration.
       ///
       /// The optional parameter \a n indicates that the initial step should be
       /// 1/n of the interval of integration.
@@ -377,15 +608,36 @@ namespace num
             /** Error tolerance.                      */ double t = 1.0E-06,
             /** Inverse of initial step size.         */ int    n = 16,
             /** Whether to store intermediate values. */ bool   s = false)
-         : deriv(f)
-         , x(x1)
-         , y(0 * x1 * f(x1))
-         , tol(t)
-         , store(s)
-         , nok(0)
-         , nbad(0)
+         : x(x1), y(0 * x1 * f(x1)), tol(t), store(s), nok(0), nbad(0)
+      {
+         init(f, x1, x2, n);
+      }
+
+      /// Numerically integrate a function of any callable type, and store the
+      /// result in rk_quad::y, exactly as by the constructor that takes
+      /// std::function.
+      ///
+      /// When \a G be the type of a lambda or other functor, rather than
+      /// std::function or a pointer to function, the compiler sees through
+      /// each of the several calls to \a f in every step, and can inline the
+      /// integrand.  For an integrand that is cheap to evaluate, the indirect
+      /// call through std::function is otherwise a large part of the run time.
+      ///
+      /// \tparam G   Type of function to be integrated, callable with X and,
+      ///             optionally, with std::array<X, batch>.
+      /// \tparam X1  Type of lower limit of integration; X1 must convert to X.
+      /// \tparam X2  Type of upper limit of integration; X2 must convert to X.
+      template <typename G, typename X1, typename X2>
+      rk_quad(
+            /** Function to be integrated.            */ G const &f,
+            /** Lower limit of integration.           */ X1       x1,
+            /** Upper limit of integration.           */ X2       x2,
+            /** Error tolerance.                      */ double   t = 1.0E-06,
+            /** Inverse of initial step size.         */ int      n = 16,
+            /** Whether to store intermediate values. */ bool     s = false)
+         : x(x1), y(0 * x * f(x)), tol(t), store(s), nok(0), nbad(0)
       {
-         init(x1, x2, n);
+         init(f, x1, x2, n);
       }
 
       /// Value of definite integral.
@@ -574,8 +826,226 @@ namespace num
       }
    };
 
+   template <typename X, typename Y, typename T>
+   unsigned constexpr rk_quad<X, Y, T>::batch;
+
    /// Short alias for Runge-Kutta solver for ordinary double-precision values.
    using rk_quadd = rk_quad<double, double>;
+
+   /// General Runge-Kutta integrator for a system of ordinary differential
+   /// equations, \f$ y' = f(x, y) \f$, where \f$ y \f$ is a vector of state.
+   ///
+   /// Each step is a step of the embedded method given by the Butcher
+   /// tableau \a T, by default the fifth-order method of Cash and Karp, and
+   /// the stepsize is adapted as in rk_quad, from the estimate of the local
+   /// truncation error by the embedded method.  Error is monitored, as in
+   /// `odeint()` of Numerical Recipes in C, relative to \f$ |y_i| + |h
+   /// y'_i| \f$ for each component \f$ i \f$, and the greatest ratio over the
+   /// components is compared against the tolerance.  If the tableau be FSAL
+   /// (first same as last), as are tableau::dopri5 and tableau::dop853, then
+   /// the derivative at the end of each step is reused at the beginning of
+   /// the next.
+   ///
+   /// The state \a S may be std::array<double, N>, for a system whose size is
+   /// known at compile time, or std::vector<double>.  The stages of the step,
+   /// the trial state, and the scale of error are kept in members of type \a
+   /// S, all sized on construction, and reused for every step; so, once
+   /// constructed, the integrator allocates nothing.  The function \a f is
+   /// called as `f(x, y, dydx)`, and it must write the derivative into \a
+   /// dydx, which is already of the right size, rather than return a new
+   /// state.
+   ///
+   /// Call integrate() to advance the state to a new value of \f$ x \f$.  It
+   /// may be called repeatedly to obtain the state at a sequence of points;
+   /// each call starts with the stepsize last estimated.
+   ///
+   /// \tparam S  Type of state: random-access container of double.
+   /// \tparam T  Butcher tableau.
+   template <typename S, typename T = tableau::cash_karp>
+   class rk_ode : rk_base
+   {
+      double x_;     ///< Independent variable.
+      S      y_;     ///< State.
+      double tol_;   ///< Error tolerance.
+      double h_;     ///< Estimated next stepsize, or zero before first step.
+      int    nok_;   ///< Number of steps with planned h.
+      int    nbad_;  ///< Number of steps with reduced h.
+      S      yt_;    ///< State at which to evaluate next stage.
+      S      yout_;  ///< State at end of trial step.
+      S      yscal_; ///< Scaling used to monitor accuracy.
+
+      /// Derivative at each stage.  The first is at the beginning of the
+      /// step.
+      std::array<S, T::stages> k_;
+
+      /// Sum, over stages, of weight times derivative of component \a m.  A
+      /// stage whose weight is zero is skipped.
+      ///
+      /// \return  Weighted sum.
+      double sum(/** Weight of each stage.  */ double const *w,
+                 /** Offset of component. */ unsigned      m) const
+      {
+         double s = 0.0;
+         for (unsigned j = 0; j < T::stages; ++j) {
+            if (w[j] != 0.0) {
+               s += w[j] * k_[j][m];
+            }
+         }
+         return s;
+      }
+
+      /// Use the method of the tableau to advance the state from \a x_ over
+      /// an interval \a h, and write the new state to \a yout_.  The
+      /// derivative \a k_[0] at the beginning must already be computed.
+      ///
+      /// This function is based on `rkck()` found on Page 719 in Numerical
+      /// Recipes in C, Second Edition.
+      ///
+      /// \tparam G  Type of function returning derivative.
+      /// \return    Greatest ratio, over the components, of estimated error
+      ///            to \a yscal_.
+      template <typename G>
+      double rkck(/** Function returning derivative. */ G const &deriv,
+                  /** Length of interval.            */ double   h)
+      {
+         unsigned const n = y_.size();
+         for (unsigned i = 1; i < T::stages; ++i) {
+            for (unsigned m = 0; m < n; ++m) {
+               yt_[m] = y_[m] + h * sum(T::a[i], m);
+            }
+            deriv(x_ + T::c[i] * h, yt_, k_[i]);
+         }
+         double err = 0.0;
+         for (unsigned m = 0; m < n; ++m) {
+            yout_[m]     = y_[m] + h * sum(T::b, m);
+            auto const r = [&](unsigned k) -> double {
+               return h * sum(T::e[k], m) / yscal_[m];
+            };
+            err = std::max(err, T::error(r));
+         }
+         return err;
+      }
+
+      /// Take one step, reducing the stepsize from \a htry until the error be
+      /// within tolerance, and advance \a x_ and \a y_.
+      ///
+      /// This function is based on `rkqs()` found on Page 719 in Numerical
+      /// Recipes in C, Second Edition.
+      ///
+      /// \tparam G  Type of function returning derivative.
+      /// \return    Stepsize that was accomplished.
+      template <typename G>
+      double rkqs(/** Function returning derivative. */ G const &deriv,
+                  /** Stepsize to be attempted.      */ double   htry,
+                  /** Estimated next stepsize.       */ double & hnext)
+      {
+         double h = htry;
+         double err;
+         while (true) {
+            err = rkck(deriv, h) / tol_; // Take a trial step.
+            if (err <= 1.0) {
+               break;
+            }
+            // Truncation error is too large.
+            h = reduce_step_size<T>(h, err);
+            if (x_ + h == x_) {
+               throw "stepsize underflow";
+            }
+         }
+         hnext = grow_step_size<T>(h, err);
+         x_ += h;
+         std::swap(y_, yout_);
+         return h;
+      }
+
+   public:
+      /// Initialize the state, and allocate storage for every stage.
+      rk_ode(
+            /** Initial value of independent variable. */ double   x,
+            /** Initial state.                         */ S const &y,
+            /** Error tolerance.                       */ double   t = 1.0E-06)
+         : x_(x),
+           y_(y),
+           tol_(check_tol(t)),
+           h_(0.0),
+           nok_(0),
+           nbad_(0),
+           yt_(y),
+           yout_(y),
+           yscal_(y)
+      {
+         k_.fill(y);
+      }
+
+      /// Current value of independent variable.
+      double x() const { return x_; }
+
+      /// Current state.
+      S const &y() const { return y_; }
+
+      /// Tolerance.
+      double tolerance() const { return tol_; }
+
+      /// Number of steps taken with the planned stepsize.
+      int nok() const { return nok_; }
+
+      /// Number of steps for which the stepsize had to be reduced.
+      int nbad() const { return nbad_; }
+
+      /// Advance the state from the current value of the independent variable
+      /// to \a x2, which may be less than the current value.  The first step
+      /// attempted is the one estimated at the end of the previous call, or,
+      /// on the first call, 1/16 of the interval.
+      ///
+      /// This function is based on `odeint()` on Page 721 of Numerical Recipes
+      /// in C, Second Edition.
+      ///
+      /// \tparam G  Type of function returning derivative, callable as
+      ///            `deriv(x, y, dydx)`.
+      template <typename G>
+      void integrate(
+            /** Function returning derivative.   */ G const &deriv,
+            /** Final value of independent var. */ double   x2)
+      {
+         double constexpr TINY = 1.0E-30;
+         double const     x1   = x_;
+         if (x2 == x1) {
+            return;
+         }
+         double h = (x2 - x1) / 16.0;
+         if (h_ * h > 0.0) {
+            h = h_;
+         }
+         unsigned const n = y_.size();
+         deriv(x_, y_, k_[0]);
+         while (true) {
+            for (unsigned i = 0; i < n; ++i) {
+               yscal_[i] = std::fabs(y_[i]) + std::fabs(k_[0][i] * h) + TINY;
+            }
+            if ((x_ + h - x2) * (x_ + h - x1) > 0.0) {
+               h = x2 - x_; // Decrease stepsize to avoid overshoot.
+            }
+            double       hnext;
+            double const hdid = rkqs(deriv, h, hnext);
+            if (hdid == h) {
+               ++nok_;
+            } else {
+               ++nbad_;
+            }
+            if ((x_ - x2) * (x2 - x1) >= 0.0) {
+               x_ = x2; // Remove round-off in last step.
+               h_ = hnext;
+               return;
+            }
+            if (T::fsal) {
+               std::swap(k_[0], k_[T::stages - 1]);
+            } else {
+               deriv(x_, y_, k_[0]);
+            }
+            h = hnext;
+         }
+      }
+   };
 }
 
 #endif // ndef NUMERIC_RK_HPP
@@ -10,11 +10,17 @@
 #ifndef NUMERIC_SPARSE_TABLE_HPP
 #define NUMERIC_SPARSE_TABLE_HPP
 
-#include <algorithm> // for upper_bound()
-#include <vector>    // for vector
+#include <algorithm>   // for is_sorted()
+#include <functional>  // for function
+#include <type_traits> // for integral_constant, is_convertible
+#include <vector>      // for vector
 
 #include <ginac/ginac.h> // for ex
 
+#include <eytzinger.hpp> // for eytzinger
+#include <outside.hpp>   // for outside::arg(), outside::fill()
+#include <poly.hpp>      // for poly
+
 namespace num
 {
    /// Allow easy conversion from expression to double.
@@ -71,6 +77,34 @@ namespace num
    ///
    /// operator()() returns \f$f_i(a)\f$.
    ///
+   /// The search for \f$i\f$ does not touch the records themselves.  On
+   /// construction, the beginning \f$a_i - \frac{\Delta a_i}{2}\f$ of every
+   /// sub-domain is copied into a compact, cache-friendly \ref eytzinger
+   /// index, and every lookup (including those in integral()) goes through the
+   /// index.
+   ///
+   /// On construction, each \f$f_i\f$ is classified.  If A convert to
+   /// double, and if \f$f_i\f$ be a polynomial of degree three or less with
+   /// numeric coefficients (as is the case for every sub-function in each
+   /// table made by make_linear_interp(), rk_quad::make_fnc_interp(), and
+   /// rk_quad::make_int_interp() when A is double), then the table also stores
+   /// a numeric copy of \f$f_i\f$ as a \ref poly.  For such a sub-function,
+   /// val() returns \f$f_i(a)\f$ as a double, and integral() integrates in
+   /// closed form, without any symbolic computation.  Only a general
+   /// sub-function goes through GiNaC.
+   ///
+   /// The numeric form is kept beside, not instead of, the symbolic one.
+   /// Every record still holds its GiNaC::ex, which dat(), the arithmetic
+   /// operators, and fuse() need, and so the table is larger rather than
+   /// smaller: for each sub-function, it also stores a \ref poly, a flag, a
+   /// key and a rank in the index, and, after cumulate(), a cumulative
+   /// integral.  Lookup and numeric evaluation are faster because they touch
+   /// only the compact arrays.  Classification costs a symbolic substitution
+   /// and expansion per sub-function, and it is repeated whenever a table is
+   /// made, including by every arithmetic operator, by fuse(), and by
+   /// operator*=() and operator/=().  For a table that is made once and then
+   /// only evaluated, frozen_table keeps the numeric form alone.
+   ///
    /// See dense_table for a type that usually can approximate a given function
    /// so precisely as sparse_table but with faster lookup. The cost is that
    /// dense_table requires more storage for the same precision with the same
@@ -93,111 +127,238 @@ namespace num
 
       using data = std::vector<rec>; ///< Type of data structure for table.
 
+      /// Type of numeric sub-function.  The argument of each is the offset
+      /// \f$a - a_i\f$ from the center of the sub-domain.
+      using piece = poly<3>;
+
    private:
       data dat_; ///< Tabular data.
 
-      /// Compare argument with record so that right record can be found.
-      static bool acomp(A const &a, rec const &r) { return a < r.a; }
+      /// Numeric sub-functions, one for each record in #dat_.  Element
+      /// \f$i\f$ is meaningful only if #isp_[i] be true.  This is empty if no
+      /// sub-function be a polynomial of degree no greater than three, with
+      /// numeric coefficients, in #x.
+      std::vector<piece> pol_;
 
-      /// Compare two records so that they can be sorted.
-      static bool rcomp(rec const &r1, rec const &r2) { return r1.a < r2.a; }
+      /// Classification of each sub-function: true if it have a numeric form
+      /// in #pol_, and false if it must be treated symbolically.
+      std::vector<bool> isp_;
 
-      /// Construct from data member, already consistently initialized and
-      /// sorted.
-      explicit sparse_table(data &&d) : dat_(std::move(d)) {}
+      /// Number of sub-functions that have a numeric form in #pol_.
+      unsigned npol_ = 0;
+
+      /// Index of beginning of each sub-domain, for fast search.  Every
+      /// lookup goes through the index rather than through #dat_, whose
+      /// records are large.
+      eytzinger<A> idx_;
+
+      /// Cumulative integral from beginning of table to beginning of each
+      /// sub-domain, and, in the final element, to the end of the table.  This
+      /// is empty unless cumulate() have been called.
+      std::vector<ex> cum_;
 
-      /// Type of function that combines two tables.
-      using cmb_func = std::function<ex(ex, ex)>;
+      /// Type of reciprocal of length of bucket.
+      using I = decltype(1.0 / A());
 
-      /// Structure for stepping through two tables to combine them via a
-      /// specified function, such as multiplication.  An instance of this is
-      /// used in sparse_table::combine().
-      struct cmb_data
+      /// For each of the uniform buckets over the domain, the offset of the
+      /// record whose sub-domain contains the beginning of the bucket.  The
+      /// final element is the offset of the last record.  This is empty
+      /// unless bucket() have been called.
+      std::vector<unsigned> bkt_;
+
+      A beg_; ///< Beginning of first bucket.
+      I ibw_; ///< Reciprocal of length of each bucket.
+
+      /// Type that is std::true_type only if A convert to double.
+      using conv = std::integral_constant<
+            bool, std::is_convertible<A, double>::value>;
+
+      /// Convert sub-function of record to numeric piece, if possible.
+      ///
+      /// \return  True only if conversion succeeded.
+      static bool to_piece(
+            /** Record to convert.     */ rec const &r,
+            /** Storage for converted. */ piece &    p,
+            /** A converts to double.  */ std::true_type)
       {
-         data            d;   ///< Data returned by sparse_table::combine().
-         unsigned        i;   ///< Offset into array of data.
-         cmb_func const &cmb; ///< Combining function.
+         using namespace GiNaC;
+         // Polynomial in offset from center.  Copy-initialization, unlike
+         // ex(r.a), is not ambiguous when A convert both to ex and to double.
+         ex const a = r.a;
+         ex const g = expand(r.f.subs(x == x + a));
+         if (!g.is_polynomial(x) || g.degree(x) > 3) {
+            return false;
+         }
+         for (int k = 0; k <= 3; ++k) {
+            ex const c = g.coeff(x, k).evalf();
+            if (!is_a<numeric>(c)) {
+               return false;
+            }
+            p.c[k] = ex_to<numeric>(c).to_double();
+         }
+         return true;
+      }
 
-         /// Initialize size, offset, and reference to combining function.
-         cmb_data(
-               /** Max size of array.  */ unsigned        sz,
-               /** Combining function. */ cmb_func const &cf)
-            : d(sz), i(0), cmb(cf)
-         {
+      /// Refuse to convert sub-function when A does not convert to double.
+      ///
+      /// \return  False.
+      static bool to_piece(rec const &, piece &, std::false_type)
+      {
+         return false;
+      }
+
+      /// Initialize #pol_, #isp_, and #npol_ from #dat_ by classifying each
+      /// sub-function.
+      void init_pol()
+      {
+         std::vector<piece> p(dat_.size());
+         isp_.assign(dat_.size(), false);
+         npol_ = 0;
+         for (unsigned i = 0; i < dat_.size(); ++i) {
+            if (to_piece(dat_[i], p[i], conv())) {
+               isp_[i] = true;
+               ++npol_;
+            }
+         }
+         if (npol_) {
+            pol_ = std::move(p);
+         } else {
+            pol_.clear();
+            isp_.clear();
          }
+      }
 
-         /// Take a step in combining two tables.  This function should be
-         /// called with parameters arranged in a way that identifies which
-         /// piece starts first in the space of arguments of type A.
-         void step(
-               /** Beg of scnd piece.                     */ A const &  b2,
-               /** End of frst piece.                     */ A const &  e1,
-               /** End of scnd piece.                     */ A const &  e2,
-               /** Piece from table on left side of comb. */ rec const &d1,
-               /** Piece from table on rght side of comb. */ rec const &d2,
-               /** Offset into frst piece's table.        */ unsigned & i1,
-               /** Offset into scnd piece's table.        */ unsigned & i2)
-         {
-            if (e1 < b2) {
-               // d1 ends before d2 starts.
-               ++i1;
-            } else if (e1 < e2) {
-               // d1 ends before d2 ends.
-               d[i].a  = 0.5 * (b2 + e1);
-               d[i].da = e1 - b2;
-               d[i].f  = cmb(d1.f, d2.f);
-               ++i1;
-               ++i;
-            } else {
-               // d1 ends after d2 ends.
-               d[i].a  = d2.a;
-               d[i].da = d2.da;
-               d[i].f  = cmb(d1.f, d2.f);
-               ++i2;
+      /// Beginning of sub-domain at offset \a i.
+      A left(/** Offset of record. */ unsigned i) const
+      {
+         return dat_[i].a - 0.5 * dat_[i].da;
+      }
+
+      /// End of sub-domain at offset \a i.
+      A right(/** Offset of record. */ unsigned i) const
+      {
+         return dat_[i].a + 0.5 * dat_[i].da;
+      }
+
+      /// Initialize #idx_ and #pol_ from #dat_.
+      void init()
+      {
+         std::vector<A> b(dat_.size());
+         for (unsigned i = 0; i < dat_.size(); ++i) {
+            b[i] = left(i);
+         }
+         idx_ = eytzinger<A>(b);
+         init_pol();
+      }
+
+      /// Find offset of record whose sub-domain contains \a a, which must
+      /// lie within the domain of the table.
+      ///
+      /// \return  Offset of record.
+      unsigned find(/** Argument to function. */ A const &a) const
+      {
+         if (bkt_.size()) {
+            // Compute bucket, and scan the few sub-domains that overlap it.
+            unsigned const nb = bkt_.size() - 1;
+            unsigned       j  = (a - beg_) * ibw_;
+            if (j >= nb) {
+               j = nb - 1;
+            }
+            unsigned       i = bkt_[j];
+            unsigned const n = dat_.size();
+            while (i + 1 < n && left(i + 1) <= a) {
                ++i;
             }
+            while (i > 0 && a < left(i)) {
+               --i; // Bucket was off by one on account of round-off.
+            }
+            return i;
          }
+         // In log time, count sub-domains beginning at or before a.
+         unsigned const u = idx_.count(a);
+         return u ? u - 1 : 0;
+      }
 
-         /// Shrink down to size if necessary. This is meant to be called after
-         /// all of the calls to step() are done.
-         void resize() { d.resize(i); }
-      };
+      /// Numeric value of sub-function at offset \a i.
+      double val_at(
+            /** Offset of record.     */ unsigned i,
+            /** Argument to function. */ A const &a) const
+      {
+         if (is_pol(i)) {
+            return pol_[i](a - dat_[i].a);
+         }
+         return dbl(dat_[i].f.subs(x == a));
+      }
 
-      /// Combine table with other table, for example by multiplication if \a
-      /// cmb represents the function for multiplication of two expressions.
+      /// Add integral of numeric sub-function at offset \a i, over part of
+      /// its sub-domain, to \a d.
       ///
-      /// \return Resutlant table.
-      sparse_table combine(
-            /** Other table.        */ sparse_table const &st,
-            /** Combining function. */ std::function<ex(ex, ex)> const &cmb)
-            const
-      {
-         // Initializer for return value.  The initial size might be too large
-         // and is reduced if necessary at the end.
-         cmb_data c(dat_.size() + st.dat().size(), cmb);
-         unsigned i1 = 0; // offset into dat_
-         unsigned i2 = 0; // offset into st.dat_
-         while (i1 < dat_.size() && i2 < st.dat().size()) {
-            auto const &d1   = dat_[i1];     // piece from left table
-            auto const &d2   = st.dat()[i2]; // piece from right table
-            auto const  hda1 = 0.5 * d1.da;
-            auto const  hda2 = 0.5 * d2.da;
-            auto const  l1   = d1.a - hda1;
-            auto const  l2   = d2.a - hda2;
-            auto const  r1   = d1.a + hda1;
-            auto const  r2   = d2.a + hda2;
-            if (l1 < l2) {
-               // d1 starts before d2.
-               c.step(l2, r1, r2, d1, d2, i1, i2);
-            } else {
-               // d2 starts before d1.
-               c.step(l1, r2, r1, d1, d2, i2, i1);
-            }
+      /// \return  False if sub-function have no numeric form.
+      bool num_part(
+            /** Offset of record.   */ unsigned i,
+            /** Beg of integration. */ A const &a,
+            /** End of integration. */ A const &b,
+            /** Numeric sum.        */ double & d,
+            /** A converts to double. */ std::true_type) const
+      {
+         if (!is_pol(i)) {
+            return false;
+         }
+         d += pol_[i].integral(a - dat_[i].a, b - dat_[i].a);
+         return true;
+      }
+
+      /// Refuse numeric integration when A does not convert to double.
+      ///
+      /// \return  False.
+      bool num_part(
+            unsigned, A const &, A const &, double &, std::false_type) const
+      {
+         return false;
+      }
+
+      /// Add integral of sub-function at offset \a i, over part of its
+      /// sub-domain, either to \a d (in closed form, if the sub-function be a
+      /// numeric polynomial) or else to \a e (symbolically).
+      void part(
+            /** Offset of record.   */ unsigned i,
+            /** Beg of integration. */ A const &a,
+            /** End of integration. */ A const &b,
+            /** Numeric sum.        */ double & d,
+            /** Symbolic sum.       */ ex &     e) const
+      {
+         if (!num_part(i, a, b, d, conv())) {
+            e += GiNaC::integral(x, a, b, dat_[i].f).eval_integ();
          }
-         c.resize(); // Shrink down to size if necessary.
-         return sparse_table(std::move(c.d));
       }
 
+      /// Integral of sub-function at offset \a i over part of its sub-domain.
+      ex part(
+            /** Offset of record.   */ unsigned i,
+            /** Beg of integration. */ A const &a,
+            /** End of integration. */ A const &b) const
+      {
+         double d = 0.0;
+         ex     e = 0;
+         part(i, a, b, d, e);
+         return e + d;
+      }
+
+      /// True if \a a lie outside domain of table.
+      bool outside(/** Argument to function. */ A const &a) const
+      {
+         auto const &frst = *dat_.begin();
+         auto const &last = *dat_.rbegin();
+         return a < frst.a - 0.5 * frst.da || a > last.a + 0.5 * last.da;
+      }
+
+      /// Compare two records so that they can be sorted.
+      static bool rcomp(rec const &r1, rec const &r2) { return r1.a < r2.a; }
+
+      /// Construct from data member, already consistently initialized and
+      /// sorted.
+      explicit sparse_table(data &&d) : dat_(std::move(d)) { init(); }
+
    public:
       /// Construct null table.
       sparse_table() {}
@@ -232,6 +393,7 @@ namespace num
             dat_[i].f  = vf[i].second;
             dat_[i].a  = dat_[i - 1].a + 0.5 * (dat_[i - 1].da + dat_[i].da);
          }
+         init();
       }
 
       /// Table of sub-domain centers, sub-domain lengths, and sub-functions:
@@ -241,6 +403,111 @@ namespace num
       /// \f$ (a_{n-1}, \Delta a_{n-1}, f_{n-1}) \f$.
       data const &dat() const { return dat_; }
 
+      /// Numeric sub-functions \f$ f_0, f_1, \ldots, f_{n-1} \f$, each taking
+      /// the offset \f$a - a_i\f$ as its argument.  Element \f$i\f$ is
+      /// meaningful only if is_pol() be true for \f$i\f$.  The list is empty
+      /// if no sub-function be a polynomial of degree three or less with
+      /// numeric coefficients.
+      std::vector<piece> const &pol() const { return pol_; }
+
+      /// True if sub-function at offset \a i have a numeric representation in
+      /// pol().  The classification is made once, on construction.
+      bool is_pol(/** Offset of record. */ unsigned i) const
+      {
+         return pol_.size() && isp_[i];
+      }
+
+      /// True if every sub-function have a numeric representation in pol().
+      bool has_pol() const { return npol_ && npol_ == dat_.size(); }
+
+      /// Precompute the integral over every sub-domain and the cumulative sum
+      /// of those integrals.  Afterward, each call to integral(A, A) costs two
+      /// integrations over partial sub-domains and a subtraction, regardless
+      /// of how many sub-domains the interval spans, and each call to
+      /// integral() costs nothing.
+      ///
+      /// The cumulative sums are scaled along with the table by operator*=()
+      /// and operator/=(), but a table returned by any other operator has no
+      /// cumulative sums until cumulate() be called on it.
+      ///
+      /// \return  Reference to present table.
+      sparse_table &cumulate()
+      {
+         cum_.resize(dat_.size() + 1);
+         ex sum = 0;
+         for (unsigned i = 0; i < dat_.size(); ++i) {
+            cum_[i]   = sum;
+            A const e = dat_[i].a + 0.5 * dat_[i].da; // end of sub-domain
+            sum       = (sum + part(i, left(i), e)).evalf();
+         }
+         cum_[dat_.size()] = sum;
+         return *this;
+      }
+
+      /// True if cumulate() have been called since the table was made.
+      bool cumulated() const { return cum_.size() > 0; }
+
+      /// Lay a directory of \a nb buckets of uniform length over the domain.
+      /// Afterward, each lookup computes the bucket containing the argument,
+      /// as dense_table does, and then scans only the sub-domains overlapping
+      /// that bucket, instead of searching the whole table in log time.
+      ///
+      /// When the sub-domains are of nearly uniform length, as is typical
+      /// for a table made by make_linear_interp(), the scan is short, and the
+      /// expected time of lookup is constant.  Where the sub-domains are
+      /// locally refined, the scan can be longer; max_scan() reports the
+      /// worst case, and more buckets shorten it at a cost of four bytes per
+      /// bucket.  The record chosen is always the same as without buckets.
+      ///
+      /// The directory survives operator*=() and operator/=(), but a table
+      /// returned by any other operator has no directory until bucket() be
+      /// called on it.
+      ///
+      /// \return  Reference to present table.
+      sparse_table &bucket(
+            /// Number of buckets, or zero for as many buckets as there are
+            /// records.
+            unsigned nb = 0)
+      {
+         bkt_.clear();
+         unsigned const n = dat_.size();
+         if (n == 0) {
+            return *this;
+         }
+         if (nb == 0) {
+            nb = n;
+         }
+         A const end = right(n - 1);
+         A const bw  = (end - left(0)) / double(nb); // Length of bucket.
+         std::vector<unsigned> b(nb + 1);
+         for (unsigned j = 0; j < nb; ++j) {
+            b[j] = find(left(0) + double(j) * bw);
+         }
+         b[nb] = n - 1;
+         beg_  = left(0);
+         ibw_  = 1.0 / bw;
+         bkt_  = std::move(b);
+         return *this;
+      }
+
+      /// Number of buckets laid by bucket(), or zero if there be none.
+      unsigned buckets() const { return bkt_.size() ? bkt_.size() - 1 : 0; }
+
+      /// Worst-case number of steps in the scan that follows the computation
+      /// of the bucket in a lookup.  This is the greatest number of
+      /// sub-domains that begin inside any one bucket.
+      ///
+      /// \return  Maximum length of scan, or zero if bucket() have not been
+      ///          called.
+      unsigned max_scan() const
+      {
+         unsigned m = 0;
+         for (unsigned j = 0; j + 1 < bkt_.size(); ++j) {
+            m = std::max(m, bkt_[j + 1] - bkt_[j]);
+         }
+         return m;
+      }
+
       /// Find \f$a_i\f$ whose sub-domain contains \f$a\f$, and return
       /// \f$f_i(a)\f$.  If
       /// \f$a < a_0     - \frac{\Delta a_{0}}{2}\f$, or
@@ -250,30 +517,107 @@ namespace num
       /// \return \f$ f_i(a) \f$.
       ex operator()(/** Argument to function. */ A const &a) const
       {
-         auto const &frst = *dat_.begin();
-         auto const &last = *dat_.rbegin();
-         if (a < frst.a - 0.5 * frst.da || a > last.a + 0.5 * last.da) {
+         if (outside(a)) {
             return 0;
          }
-         // In log time, find pointer to first record after argument a.
-         auto p = std::upper_bound(dat_.begin(), dat_.end(), a, acomp);
-         if (p == dat_.end()) {
-            return last.f.subs(x == a); // Argument a is after last center.
-         } else if (p->a - a > 0.5 * p->da) {
-            --p; // Argument a is too far from subsequent center.
+         return dat_[find(a)].f.subs(x == a);
+      }
+
+      /// Find \f$a_i\f$ whose sub-domain contains \f$a\f$, and return
+      /// \f$f_i(a)\f$ as a double.  If
+      /// \f$a < a_0     - \frac{\Delta a_{0}}{2}\f$, or
+      /// \f$a > a_{n-1} + \frac{\Delta a_{n-1}}{2}\f$,
+      /// then return 0.
+      ///
+      /// When is_pol() be true for \f$i\f$, the evaluation involves no
+      /// symbolic computation and no allocation; otherwise, the value is
+      /// computed symbolically as by operator()() and then converted.
+      ///
+      /// \return \f$ f_i(a) \f$.
+      double val(/** Argument to function. */ A const &a) const
+      {
+         if (outside(a)) {
+            return 0.0;
+         }
+         return val_at(find(a), a);
+      }
+
+      /// Find \f$a_i\f$ whose sub-domain contains \f$a\f$, and return
+      /// \f$f_i(a)\f$ as a double.  If \f$a\f$ lie outside the domain, then
+      /// proceed according to the policy \a P, as for dense_table.  Unless
+      /// the policy be outside::unchecked, the search for the record is
+      /// clamped to the table.
+      ///
+      /// \return \f$ f_i(a) \f$.
+      template <typename P>
+      double val(
+            /** Argument to function.  */ A const &a,
+            /** Policy outside domain. */ P) const
+      {
+         if (P::mask && outside(a)) {
+            return outside::fill<double>(P());
+         }
+         A const  lo = left(0);
+         A const  hi = right(dat_.size() - 1);
+         A const &c  = outside::arg<P>(a, lo, hi);
+         A const &k  = P::check ? outside::arg<outside::clamp>(c, lo, hi) : c;
+         return val_at(find(k), c);
+      }
+
+      /// Evaluate the table at each argument in a range, and write each
+      /// result, as computed by val(A const&), to the output.
+      ///
+      /// When the arguments be sorted in non-decreasing order, the records
+      /// are located by a single forward walk through the table, so that
+      /// the whole batch costs time proportional to the sum of the number of
+      /// arguments and the number of records.  Otherwise, each argument is
+      /// located through the search index.  In either case, the result
+      /// for each argument is identical to that returned by val(A const&).
+      ///
+      /// \tparam I  Type of forward iterator over arguments.
+      /// \tparam O  Type of output iterator for results.
+      /// \return    Output iterator just past last result written.
+      template <typename I, typename O>
+      O val(
+            /** Iterator to first argument.       */ I first,
+            /** Iterator just past last argument. */ I last,
+            /** Iterator to first output.         */ O out) const
+      {
+         if (std::is_sorted(first, last)) {
+            unsigned u = 0; // number of sub-domains beginning before arg.
+            for (; first != last; ++first, ++out) {
+               A const &a = *first;
+               if (outside(a)) {
+                  *out = 0.0;
+                  continue;
+               }
+               while (u < dat_.size() && left(u) <= a) {
+                  ++u;
+               }
+               *out = val_at(u ? u - 1 : 0, a);
+            }
+         } else {
+            for (; first != last; ++first, ++out) {
+               A const &a = *first;
+               *out = outside(a) ? 0.0 : val_at(find(a), a);
+            }
          }
-         return p->f.subs(x == a);
+         return out;
       }
 
       /// Integral of piece-wise function over all pieces.
       ex integral() const
       {
-         ex rv = 0; // Return value.
-         for (auto i : dat_) {
-            rv += GiNaC::integral(x, i.a - 0.5 * i.da, i.a + 0.5 * i.da, i.f)
-                        .eval_integ();
+         if (cum_.size()) {
+            return cum_.back();
          }
-         return rv.evalf();
+         ex     rv = 0;   // Symbolic part of return value.
+         double dv = 0.0; // Numeric part of return value.
+         for (unsigned i = 0; i < dat_.size(); ++i) {
+            auto const &r = dat_[i];
+            part(i, r.a - 0.5 * r.da, r.a + 0.5 * r.da, dv, rv);
+         }
+         return (rv + dv).evalf();
       }
 
       /// Integral of piece-wise function over range.
@@ -284,7 +628,8 @@ namespace num
             sign = -1.0;
             std::swap(a, b);
          }
-         ex rv = 0; // Return value.
+         ex     rv = 0;   // Symbolic part of return value.
+         double dv = 0.0; // Numeric part of return value.
          if (dat_.size() == 0) {
             return rv; // There are no pieces over which to integrate.
          }
@@ -302,21 +647,19 @@ namespace num
          if (b > end) {
             b = end; // Interval is partially after the last piece.
          }
-         auto pa = std::upper_bound(dat_.begin(), dat_.end(), a, acomp);
-         auto pb = std::upper_bound(dat_.begin(), dat_.end(), b, acomp);
-         if (pa == dat_.end()) {
-            // Beginning of interval is after last center.
-            return (sign * GiNaC::integral(x, a, b, dat_.rbegin()->f))
-                  .eval_integ()
-                  .evalf();
-         } else if (pa->a - a > 0.5 * pa->da) {
-            --pa; // Beginning of interval is too far from subsequent center.
-         }
-         if (pb == dat_.end() || pb->a - b > 0.5 * pb->da) {
-            // End of interval is after last center or too far from subsequent
-            // center.
-            --pb;
+         // In log time, find first and last pieces in interval.
+         unsigned const ia = find(a);
+         unsigned const ib = find(b);
+         if (cum_.size()) {
+            // Difference between cumulative integrals at ends of interval.
+            double db = 0.0;
+            ex     eb = cum_[ib];
+            part(ib, left(ib), b, db, eb);
+            part(ia, left(ia), a, dv, rv);
+            return (sign * (eb + db - cum_[ia] - rv - dv)).evalf();
          }
+         auto const pa = dat_.begin() + ia;
+         auto const pb = dat_.begin() + ib;
          auto const pend = pb + 1;
          for (auto i = pa; i != pend; ++i) {
             A aa;                       // Current beg of integration.
@@ -332,9 +675,9 @@ namespace num
                bb = i->a + 0.5 * i->da; // End of piece.
             }                           //
             // Integral over current piece.
-            rv += GiNaC::integral(x, aa, bb, i->f).eval_integ();
+            part(i - dat_.begin(), aa, bb, dv, rv);
          }
-         return (sign * rv).evalf();
+         return (sign * (rv + dv)).evalf();
       }
 
       /// Multiply table by scale factor on right.
@@ -381,6 +724,10 @@ namespace num
          for (unsigned i = 0; i < dat_.size(); ++i) {
             dat_[i].f *= rf;
          }
+         for (auto &c : cum_) {
+            c = (c * rf).evalf();
+         }
+         init_pol();
          return *this;
       }
 
@@ -390,32 +737,215 @@ namespace num
          for (unsigned i = 0; i < dat_.size(); ++i) {
             dat_[i].f /= rf;
          }
+         for (auto &c : cum_) {
+            c = (c / rf).evalf();
+         }
+         init_pol();
          return *this;
       }
 
       /// Add table to other table.
       sparse_table operator+(/** Other table. */ sparse_table const &st) const
       {
-         return combine(st, [](ex const &a, ex const &b) { return a + b; });
+         return fuse({*this, st}, [](std::vector<ex> const &f) {
+            return f[0] + f[1];
+         });
       }
 
       /// Subtract other table from table.
       sparse_table operator-(/** Other table. */ sparse_table const &st) const
       {
-         return combine(st, [](ex const &a, ex const &b) { return a - b; });
+         return fuse({*this, st}, [](std::vector<ex> const &f) {
+            return f[0] - f[1];
+         });
       }
 
       /// Multiply table by other table.
       sparse_table operator*(/** Other table. */ sparse_table const &st) const
       {
-         return combine(st, [](ex const &a, ex const &b) { return a * b; });
+         return fuse({*this, st}, [](std::vector<ex> const &f) {
+            return f[0] * f[1];
+         });
       }
 
       /// Divide table by other table.
       sparse_table operator/(/** Other table. */ sparse_table const &st) const
       {
-         return combine(st, [](ex const &a, ex const &b) { return a / b; });
+         return fuse({*this, st}, [](std::vector<ex> const &f) {
+            return f[0] / f[1];
+         });
+      }
+
+      /// Type of function that combines the sub-functions of several tables.
+      /// The \f$k\f$th element of the argument is the sub-function of the
+      /// \f$k\f$th table.
+      using fuse_func = std::function<ex(std::vector<ex> const &)>;
+
+      /// Type of list of tables to be fused.
+      using fuse_list =
+            std::vector<std::reference_wrapper<sparse_table const>>;
+
+      /// Combine several tables in a single pass, for example
+      ///
+      ///    fuse({a, b, c, d}, [](std::vector<ex> const &f) {
+      ///       return f[0] * f[1] + f[2] * f[3];
+      ///    });
+      ///
+      /// for the product-sum that would otherwise be written as `a*b + c*d`.
+      /// The breakpoints of all of the tables are merged at once, and each
+      /// piece of the result is built by a single call to \a cmb.  So no
+      /// intermediate table is made, and no intermediate expression is
+      /// simplified.
+      ///
+      /// The domain of the result is the intersection of the domains of the
+      /// tables.  Each binary operator, such as operator*(), is implemented
+      /// as a call to fuse() with two tables.  A piece of the result
+      /// that coincides with a piece of one of the tables takes its center and
+      /// length from that piece.
+      ///
+      /// \return  Resultant table, which is null if \a t be empty or if the
+      ///          domains of the tables not overlap.
+      static sparse_table fuse(
+            /** Tables to combine.  */ fuse_list const &t,
+            /** Combining function. */ fuse_func const &cmb)
+      {
+         unsigned const m = t.size(); // Number of tables.
+         if (m == 0) {
+            return sparse_table();
+         }
+         std::vector<unsigned> i(m, 0); // Offset into each table.
+         std::vector<ex>       f(m);    // Sub-function from each table.
+         unsigned              sz = 0;  // Upper bound on size of result.
+         for (unsigned k = 0; k < m; ++k) {
+            if (t[k].get().dat_.size() == 0) {
+               return sparse_table();
+            }
+            sz += t[k].get().dat_.size();
+         }
+         // Domain of result.
+         A b = t[0].get().left(0);
+         A e = t[0].get().right(t[0].get().dat_.size() - 1);
+         for (unsigned k = 1; k < m; ++k) {
+            auto const &tk = t[k].get();
+            A const     bk = tk.left(0);
+            A const     ek = tk.right(tk.dat_.size() - 1);
+            if (b < bk) {
+               b = bk;
+            }
+            if (ek < e) {
+               e = ek;
+            }
+         }
+         data d;
+         d.reserve(sz);
+         while (b < e) {
+            // Advance each table to piece containing b, and find end of
+            // piece of result.
+            A r = e;
+            for (unsigned k = 0; k < m; ++k) {
+               auto const &tk = t[k].get();
+               while (tk.right(i[k]) <= b) {
+                  ++i[k];
+               }
+               A const rk = tk.right(i[k]);
+               if (rk < r) {
+                  r = rk;
+               }
+               f[k] = tk.dat_[i[k]].f;
+            }
+            rec p;
+            p.a  = 0.5 * (b + r);
+            p.da = r - b;
+            for (unsigned k = 0; k < m; ++k) {
+               auto const &tk = t[k].get();
+               if (tk.left(i[k]) == b && tk.right(i[k]) == r) {
+                  p.a  = tk.dat_[i[k]].a;
+                  p.da = tk.dat_[i[k]].da;
+                  break;
+               }
+            }
+            p.f = cmb(f);
+            d.push_back(p);
+            b = r;
+         }
+         return sparse_table(std::move(d));
       }
+
+      /// Evaluator bound to a sparse_table for sequential lookups.
+      ///
+      /// An instance of cursor remembers the offset of the record found by the
+      /// most recent lookup.  On the next lookup, that record and its
+      /// immediate neighbors are checked before the table's index is searched.
+      /// So, when subsequent arguments fall in the same sub-domain or in an
+      /// adjacent one (as in the steps of an integrator or of a time-stepping
+      /// loop), the lookup takes constant time.  The record chosen is always
+      /// the same as that chosen by the table itself.
+      ///
+      /// A cursor holds only a pointer to the table and an offset, so it is
+      /// cheap to keep one for each thread.  A cursor must not outlive its
+      /// table, and the table must not be modified while the cursor is in
+      /// use.
+      class cursor
+      {
+         sparse_table const *t_; ///< Table.
+         unsigned            i_; ///< Offset of most recently found record.
+
+         /// Find offset of record whose sub-domain contains \a a, which must
+         /// lie within the domain of the table.
+         ///
+         /// \return  Offset of record.
+         unsigned find(/** Argument to function. */ A const &a)
+         {
+            unsigned const n = t_->dat_.size();
+            if (t_->left(i_) <= a) {
+               if (i_ + 1 == n || a < t_->left(i_ + 1)) {
+                  return i_; // Same sub-domain as before.
+               }
+               if (i_ + 2 == n || a < t_->left(i_ + 2)) {
+                  return ++i_; // Next sub-domain.
+               }
+            } else if (i_ > 0 && t_->left(i_ - 1) <= a) {
+               return --i_; // Previous sub-domain.
+            }
+            return i_ = t_->find(a);
+         }
+
+      public:
+         /// Bind cursor to table.
+         explicit cursor(/** Table. */ sparse_table const &t) : t_(&t), i_(0)
+         {
+         }
+
+         /// Offset of record found by most recent lookup.
+         unsigned off() const { return i_; }
+
+         /// Same as sparse_table::operator()() but usually faster for
+         /// sequential access.
+         ///
+         /// \return \f$ f_i(a) \f$.
+         ex operator()(/** Argument to function. */ A const &a)
+         {
+            if (t_->outside(a)) {
+               return 0;
+            }
+            return t_->dat_[find(a)].f.subs(x == a);
+         }
+
+         /// Same as sparse_table::val() but usually faster for sequential
+         /// access.
+         ///
+         /// \return \f$ f_i(a) \f$.
+         double val(/** Argument to function. */ A const &a)
+         {
+            if (t_->outside(a)) {
+               return 0.0;
+            }
+            return t_->val_at(find(a), a);
+         }
+      };
+
+      /// Evaluator for sequential lookups in present table.
+      cursor cur() const { return cursor(*this); }
    };
 }
 
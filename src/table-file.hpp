@@ -0,0 +1,488 @@
+
+// Copyright 2016-2017  Thomas E. Vaughan
+//
+// This software is distributable under the terms of the GNU LGPL, Version 3 or
+// later.
+
+/// \file   table-file.hpp
+/// \brief  Definition of num::write_table() and num::mapped_table.
+
+#ifndef NUMERIC_TABLE_FILE_HPP
+#define NUMERIC_TABLE_FILE_HPP
+
+#include <cstdint>  // for uint32_t, uint64_t
+#include <cstring>  // for memcmp(), memcpy()
+#include <fstream>  // for ofstream
+#include <string>   // for string
+#include <utility>  // for move(), swap()
+#include <vector>   // for vector
+
+#include <fcntl.h>    // for open()
+#include <sys/mman.h> // for mmap(), munmap()
+#include <sys/stat.h> // for fstat()
+#include <unistd.h>   // for close()
+
+#include <dense-table.hpp>  // for dense_table
+#include <dim-exps.hpp>     // for dim_exps
+#include <eytzinger.hpp>    // for eytzinger
+#include <frozen-table.hpp> // for frozen_table
+#include <poly.hpp>         // for poly
+
+namespace num
+{
+   /// Header at the beginning of a binary file written by write_table().
+   ///
+   /// Every field is written in the byte order of the machine that writes
+   /// the file, and #endian records that order.  The size of the header is a
+   /// multiple of eight bytes, and so is the size of every array that
+   /// follows it, so that every array of doubles in a memory-mapped file is
+   /// aligned.
+   ///
+   /// After the header, a file for a sparse table (#kind = 0) contains
+   ///
+   /// - the \f$n+1\f$ boundaries of the sub-domains,
+   /// - the \f$n\f$ centers of the sub-domains,
+   /// - the \f$n(D+1)\f$ coefficients of the sub-functions,
+   /// - the \f$n+1\f$ cumulative integrals at the boundaries,
+   /// - the \f$n\f$ left boundaries in Eytzinger order, preceded by an
+   ///   unused element (see eytzinger::keys()),
+   /// - the \f$n+1\f$ corresponding ranks as 32-bit unsigned integers (see
+   ///   eytzinger::ranks()), padded to a multiple of eight bytes.
+   ///
+   /// A file for a dense table (#kind = 1) contains
+   ///
+   /// - the \f$n(D+1)\f$ coefficients of the sub-functions,
+   /// - the \f$n+1\f$ cumulative integrals at the boundaries.
+   struct table_header
+   {
+      char     magic[8]; ///< Identification of format: "numtab\0\0".
+      uint32_t endian;   ///< 0x01020304, in byte order of writer.
+      uint32_t version;  ///< Version of format.
+      uint32_t kind;     ///< 0 for sparse table; 1 for dense table.
+      uint32_t degree;   ///< Degree \f$D\f$ of every sub-function.
+      uint64_t n;        ///< Number \f$n\f$ of sub-functions.
+      char     dim_a[8]; ///< Dimensional exponents of argument.
+      char     dim_f[8]; ///< Dimensional exponents of function.
+      double   a0;       ///< For dense table, center of first sub-domain.
+      double   da;       ///< For dense table, length of every sub-domain.
+
+      /// Current version of format.
+      static uint32_t constexpr current = 1;
+
+      /// Initialize fields common to every kind of table.
+      table_header(
+            /** Kind of table.                */ uint32_t        k,
+            /** Degree of sub-functions.      */ uint32_t        d,
+            /** Number of sub-functions.      */ uint64_t        nn,
+            /** Dimensions of argument.       */ dim_exps const &ea,
+            /** Dimensions of function.       */ dim_exps const &ef)
+         : magic{'n', 'u', 'm', 't', 'a', 'b', 0, 0}, endian(0x01020304),
+           version(current), kind(k), degree(d), n(nn), a0(0.0), da(0.0)
+      {
+         std::memcpy(dim_a, &ea.n(), 8);
+         std::memcpy(dim_f, &ef.n(), 8);
+      }
+   };
+
+   static_assert(sizeof(table_header) == 64, "table_header must be packed.");
+
+   /// Write array to binary stream, and pad to multiple of eight bytes.
+   template <typename T>
+   void write_array(
+         /** Stream.          */ std::ofstream &        os,
+         /** Array to write.  */ T const *              p,
+         /** Number of items. */ uint64_t               n)
+   {
+      uint64_t const sz  = n * sizeof(T);
+      char const     z[8] = {};
+      os.write(reinterpret_cast<char const *>(p), sz);
+      os.write(z, (8 - sz % 8) % 8);
+   }
+
+   /// Open binary stream for write_table().
+   ///
+   /// \return  Stream.
+   inline std::ofstream open_table(/** Name of file. */ std::string const &f)
+   {
+      std::ofstream os(f, std::ios::binary | std::ios::trunc);
+      if (!os) {
+         throw "Cannot open table file for writing.";
+      }
+      return os;
+   }
+
+   /// Write a sparse table to a binary file that can later be opened by
+   /// mapped_table.  The dimensions are recorded so that, when the file is
+   /// read, the argument and the value can be restored to the units in which
+   /// the table was made.
+   inline void write_table(
+         /** Name of file.           */ std::string const & file,
+         /** Table to write.         */ frozen_table const &t,
+         /** Dimensions of argument. */ dim_exps const &    ea = dim_exps(),
+         /** Dimensions of function. */ dim_exps const &    ef = dim_exps())
+   {
+      if (t.size() == 0) {
+         throw "Cannot write empty table.";
+      }
+      std::ofstream      os = open_table(file);
+      table_header const h(0, 3, t.size(), ea, ef);
+      uint64_t const     n = t.size();
+      os.write(reinterpret_cast<char const *>(&h), sizeof(h));
+      write_array(os, t.bounds().data(), n + 1);
+      write_array(os, t.centers().data(), n);
+      write_array(os, t.pol()[0].c, n * 4);
+      write_array(os, t.cum().data(), n + 1);
+      write_array(os, t.index().keys().data(), n + 1);
+      std::vector<uint32_t> const r(
+            t.index().ranks().begin(), t.index().ranks().end());
+      write_array(os, r.data(), n + 1);
+      if (!os) {
+         throw "Cannot write table file.";
+      }
+   }
+
+   /// Write a dense table of polynomial sub-functions to a binary file that
+   /// can later be opened by mapped_table.
+   ///
+   /// \tparam D  Degree of each sub-function; at most three.
+   template <unsigned D>
+   void write_table(
+         /** Name of file.           */ std::string const &file,
+         /** Table to write.         */ dense_table<double, poly<D>> const &t,
+         /** Dimensions of argument. */ dim_exps const &ea = dim_exps(),
+         /** Dimensions of function. */ dim_exps const &ef = dim_exps())
+   {
+      static_assert(D <= 3, "mapped_table supports degree up to 3.");
+      uint64_t const n = t.f().size();
+      table_header   h(1, D, n, ea, ef);
+      h.a0             = t.a_frst();
+      h.da             = t.da();
+      double const  w  = 0.5 * t.da();
+      std::vector<double> cum(n + 1);
+      cum[0] = 0.0;
+      for (unsigned i = 0; i < n; ++i) {
+         cum[i + 1] = cum[i] + t.f()[i].integral(-w, w);
+      }
+      std::ofstream os = open_table(file);
+      os.write(reinterpret_cast<char const *>(&h), sizeof(h));
+      write_array(os, t.f()[0].c, n * (D + 1));
+      write_array(os, cum.data(), n + 1);
+      if (!os) {
+         throw "Cannot write table file.";
+      }
+   }
+
+   /// Read-only view of a table written by write_table(), mapped into memory
+   /// and used in place.
+   ///
+   /// The file is mapped with mmap(), and every lookup reads directly from
+   /// the mapped pages; nothing is parsed or copied on construction beyond
+   /// checking the header.  Because the mapping is shared and read-only,
+   /// every process that maps the same file shares the same physical pages,
+   /// and the time to open the table does not depend on its size.
+   ///
+   /// Lookup chooses the same sub-function as the table that was written:
+   /// for a sparse table, the same as frozen_table (and sparse_table); for a
+   /// dense table, the same as dense_table.  The instance holds no mutable
+   /// state, and so it may be read concurrently by several threads.
+   ///
+   /// A file written on a machine of different byte order cannot be used in
+   /// place, and an exception is thrown if such a file be opened.  The file
+   /// must not be rewritten while it is mapped, but it may be removed.
+   class mapped_table
+   {
+      void *              map_ = nullptr; ///< Beginning of mapping.
+      uint64_t            len_ = 0;       ///< Length of mapping.
+      table_header const *h_   = nullptr; ///< Header.
+      double const *      b_   = nullptr; ///< Boundaries, if sparse.
+      double const *      a_   = nullptr; ///< Centers, if sparse.
+      double const *      c_   = nullptr; ///< Coefficients.
+      double const *      cum_ = nullptr; ///< Cumulative integrals.
+      double const *      k_   = nullptr; ///< Eytzinger keys, if sparse.
+      unsigned const *    r_   = nullptr; ///< Eytzinger ranks, if sparse.
+      unsigned            n_   = 0;       ///< Number of sub-functions.
+      unsigned            d_   = 0;       ///< Degree of sub-functions.
+      double              lo_  = 0.0;     ///< Beginning of domain.
+      double              hi_  = 0.0;     ///< End of domain.
+      double              ida_ = 0.0;     ///< Inverse length, if dense.
+
+      /// Release mapping, if any.
+      void unmap()
+      {
+         if (map_) {
+            munmap(map_, len_);
+            map_ = nullptr;
+         }
+      }
+
+      /// Take array of \a n items of type T from mapping at offset \a off,
+      /// and advance \a off past the array and its padding.
+      ///
+      /// \return  Pointer to array.
+      template <typename T>
+      T const *take(
+            /** Offset into mapping. */ uint64_t &off,
+            /** Number of items.     */ uint64_t  n)
+      {
+         uint64_t const sz = n * sizeof(T);
+         if (off + sz > len_) {
+            throw "Table file is truncated.";
+         }
+         T const *const p = reinterpret_cast<T const *>(
+               static_cast<char const *>(map_) + off);
+         off += sz + (8 - sz % 8) % 8;
+         return p;
+      }
+
+      /// Center of sub-domain at offset \a i.
+      double center(/** Offset. */ unsigned i) const
+      {
+         return b_ ? a_[i] : h_->a0 + i * h_->da;
+      }
+
+      /// Beginning of sub-domain at offset \a i.
+      double left(/** Offset. */ unsigned i) const
+      {
+         return b_ ? b_[i] : center(i) - 0.5 * h_->da;
+      }
+
+      /// Offset of sub-domain containing \a a, which must lie within the
+      /// domain.
+      unsigned find(/** Argument to function. */ double a) const
+      {
+         if (b_) {
+            unsigned const u = eytzinger<double>::count(k_, r_, n_, a);
+            return u ? u - 1 : 0;
+         }
+         int i = (a - h_->a0) * ida_ + 0.5;
+         return i < int(n_) ? i : n_ - 1;
+      }
+
+      /// Value of sub-function at offset \a i, at offset \a t from center.
+      double piece(/** Offset. */ unsigned i, /** Offset. */ double t) const
+      {
+         double const *const c = c_ + i * (d_ + 1);
+         double               r = c[d_];
+         for (unsigned k = d_; k > 0; --k) {
+            r = r * t + c[k - 1];
+         }
+         return r;
+      }
+
+      /// Integral of sub-function at offset \a i from beginning of its
+      /// sub-domain to \a a.
+      double part(/** Offset. */ unsigned i, /** End. */ double a) const
+      {
+         double const *const c  = c_ + i * (d_ + 1);
+         double const        t1 = left(i) - center(i);
+         double const        t2 = a - center(i);
+         double              r1 = c[d_] / (d_ + 1);
+         double              r2 = r1;
+         for (unsigned k = d_; k > 0; --k) {
+            r1 = r1 * t1 + c[k - 1] / k;
+            r2 = r2 * t2 + c[k - 1] / k;
+         }
+         return r2 * t2 - r1 * t1;
+      }
+
+   public:
+      /// Map file written by write_table().
+      explicit mapped_table(/** Name of file. */ std::string const &file)
+      {
+         int const fd = open(file.c_str(), O_RDONLY);
+         if (fd < 0) {
+            throw "Cannot open table file.";
+         }
+         struct stat st;
+         if (fstat(fd, &st) != 0 || st.st_size < int(sizeof(table_header))) {
+            close(fd);
+            throw "Table file is truncated.";
+         }
+         len_ = st.st_size;
+         map_ = mmap(nullptr, len_, PROT_READ, MAP_SHARED, fd, 0);
+         close(fd);
+         if (map_ == MAP_FAILED) {
+            map_ = nullptr;
+            throw "Cannot map table file.";
+         }
+         try {
+            h_ = static_cast<table_header const *>(map_);
+            if (std::memcmp(h_->magic, "numtab\0\0", 8) != 0) {
+               throw "Not a table file.";
+            }
+            if (h_->endian != 0x01020304) {
+               throw "Table file has foreign byte order.";
+            }
+            if (h_->version > table_header::current) {
+               throw "Table file has unsupported version.";
+            }
+            if (h_->kind > 1 || h_->n == 0 || h_->n >= (1ull << 31)) {
+               throw "Table file is corrupt.";
+            }
+            // Check degree before any size is computed from it.
+            if (h_->degree > 3 || (h_->kind == 0 && h_->degree != 3)) {
+               throw "Table file is corrupt.";
+            }
+            n_           = h_->n;
+            d_           = h_->degree;
+            uint64_t off = sizeof(table_header);
+            if (h_->kind == 0) {
+               b_   = take<double>(off, n_ + 1);
+               a_   = take<double>(off, n_);
+               c_   = take<double>(off, uint64_t(n_) * (d_ + 1));
+               cum_ = take<double>(off, n_ + 1);
+               k_   = take<double>(off, n_ + 1);
+               r_   = take<unsigned>(off, n_ + 1);
+               lo_  = b_[0];
+               hi_  = b_[n_];
+               // Check ranks once, so that find() cannot leave arrays.
+               for (unsigned k = 1; k <= n_; ++k) {
+                  if (r_[k] > n_) {
+                     throw "Table file is corrupt.";
+                  }
+               }
+            } else {
+               if (!(h_->da > 0.0)) {
+                  throw "Table file is corrupt.";
+               }
+               c_   = take<double>(off, uint64_t(n_) * (d_ + 1));
+               cum_ = take<double>(off, n_ + 1);
+               ida_ = 1.0 / h_->da;
+               lo_  = h_->a0 - 0.5 * h_->da;
+               hi_  = h_->a0 + (n_ - 1) * h_->da + 0.5 * h_->da;
+            }
+         } catch (...) {
+            unmap();
+            throw;
+         }
+      }
+
+      mapped_table(mapped_table const &) = delete;
+      mapped_table &operator=(mapped_table const &) = delete;
+
+      /// Take over mapping from other instance.
+      mapped_table(/** Other instance. */ mapped_table &&o)
+      {
+         *this = std::move(o);
+      }
+
+      /// Take over mapping from other instance.
+      mapped_table &operator=(/** Other instance. */ mapped_table &&o)
+      {
+         if (this != &o) {
+            unmap();
+            map_   = o.map_;
+            len_   = o.len_;
+            h_     = o.h_;
+            b_     = o.b_;
+            a_     = o.a_;
+            c_     = o.c_;
+            cum_   = o.cum_;
+            k_     = o.k_;
+            r_     = o.r_;
+            n_     = o.n_;
+            d_     = o.d_;
+            lo_    = o.lo_;
+            hi_    = o.hi_;
+            ida_   = o.ida_;
+            o.map_ = nullptr;
+         }
+         return *this;
+      }
+
+      /// Release mapping.
+      ~mapped_table() { unmap(); }
+
+      /// True if file contain dense table; false if sparse table.
+      bool dense() const { return b_ == nullptr; }
+
+      /// Number of sub-functions.
+      unsigned size() const { return n_; }
+
+      /// Degree of every sub-function.
+      unsigned degree() const { return d_; }
+
+      /// Dimensional exponents of argument.
+      dim_exps dim_a() const
+      {
+         char const *e = h_->dim_a;
+         return dim_exps(e[0], e[1], e[2], e[3], e[4]);
+      }
+
+      /// Dimensional exponents of function.
+      dim_exps dim_f() const
+      {
+         char const *e = h_->dim_f;
+         return dim_exps(e[0], e[1], e[2], e[3], e[4]);
+      }
+
+      /// Find sub-domain containing \a a, and return value of its
+      /// sub-function.  If \a a lie outside the domain of the table, then
+      /// return 0.
+      ///
+      /// \return  Value of piecewise function at \a a.
+      double val(/** Argument to function. */ double a) const
+      {
+         if (a < lo_ || a > hi_) {
+            return 0.0;
+         }
+         unsigned const i = find(a);
+         return piece(i, a - center(i));
+      }
+
+      /// Same as val().
+      double operator()(/** Argument to function. */ double a) const
+      {
+         return val(a);
+      }
+
+      /// Evaluate function at each argument in [\a first, \a last), and write
+      /// results to \a out.
+      ///
+      /// \return  Iterator past last result written.
+      template <typename I, typename O>
+      O val(
+            /** Iterator to first argument.  */ I first,
+            /** Iterator past last argument. */ I last,
+            /** Iterator to first result.    */ O out) const
+      {
+         for (; first != last; ++first, ++out) {
+            *out = val(*first);
+         }
+         return out;
+      }
+
+      /// Integral over the whole domain.
+      ///
+      /// \return  Integral.
+      double integral() const { return cum_[n_]; }
+
+      /// Integral from \a a to \a b, in constant time after two lookups.
+      /// Any part of the interval outside the domain contributes nothing.
+      ///
+      /// \return  Integral.
+      double integral(
+            /** Beg of range. */ double a, /** End of range. */ double b) const
+      {
+         double sign = 1.0;
+         if (a > b) {
+            sign = -1.0;
+            std::swap(a, b);
+         }
+         if (a > hi_ || b < lo_) {
+            return 0.0;
+         }
+         if (a < lo_) {
+            a = lo_;
+         }
+         if (b > hi_) {
+            b = hi_;
+         }
+         unsigned const ia = find(a);
+         unsigned const ib = find(b);
+         return sign * (cum_[ib] + part(ib, b) - cum_[ia] - part(ia, a));
+      }
+   };
+}
+
+#endif // ndef NUMERIC_TABLE_FILE_HPP
@@ -0,0 +1,326 @@
+
+// Copyright 2016-2017  Thomas E. Vaughan
+//
+// This software is distributable under the terms of the GNU LGPL, Version 3 or
+// later.
+
+/// \file   tableau.hpp
+/// \brief  Definition of Butcher tableaux in num::tableau for rk_quad and
+///         rk_ode.
+
+#ifndef NUMERIC_TABLEAU_HPP
+#define NUMERIC_TABLEAU_HPP
+
+#include <cmath> // for fabs(), sqrt()
+
+namespace num
+{
+   /// Butcher tableaux of embedded Runge-Kutta methods, each of which may be
+   /// passed as a template argument to rk_quad or to rk_ode.
+   ///
+   /// A tableau is a type whose members are all static and constexpr:
+   ///
+   /// - \a stages: number \f$ s \f$ of stages;
+   /// - \a order: order \f$ q \f$ of the estimate of error, which is
+   ///   assumed to scale as \f$ h^{q+1} \f$, and from which the stepsize is
+   ///   adapted;
+   /// - \a fsal: true if the last stage be evaluated at the end of the step,
+   ///   on the new state, so that it is the first stage of the next step;
+   /// - \a estimates: number of rows in \a e;
+   /// - \a c: node \f$ c_i \f$ of each stage;
+   /// - \a a: coefficient \f$ a_{ij} \f$ of stage \f$ j \f$ in the state at
+   ///   which stage \f$ i > j \f$ is evaluated;
+   /// - \a b: weight \f$ b_i \f$ of each stage in the new state;
+   /// - \a e: weights of each stage in each estimate of error;
+   /// - error(): the ratio of error to scale, computed from the estimates.
+   ///
+   /// Because the coefficients are constant expressions, and every loop over
+   /// the stages has a constant number of iterations, the compiler can
+   /// unroll each loop and fold each coefficient into the code; a
+   /// coefficient that is zero costs nothing.
+   ///
+   /// Each tableau is a template only so that its arrays, which are indexed
+   /// at run time, can be defined in this header.  The alias without the
+   /// prefix \c basic_ is the one to use.
+   namespace tableau
+   {
+      /// Fifth-order method of Cash and Karp, with embedded fourth-order
+      /// estimate of error, as in Numerical Recipes in C, Second Edition,
+      /// Page 717.  This is the default.
+      template <typename = void>
+      struct basic_cash_karp
+      {
+         static unsigned constexpr stages    = 6;     ///< Stages.
+         static unsigned constexpr order     = 4;     ///< Order of estimate.
+         static bool constexpr     fsal      = false; ///< Not FSAL.
+         static unsigned constexpr estimates = 1;     ///< Rows of \a e.
+
+         /// Nodes.
+         static double constexpr c[stages] = {0.0, 0.2, 0.3, 0.6, 1.0, 0.875};
+
+         /// Coefficients of earlier stages in each stage.
+         static double constexpr a[stages][stages] = {
+               {},
+               {0.2},
+               {3.0 / 40.0, 9.0 / 40.0},
+               {0.3, -0.9, 1.2},
+               {-11.0 / 54.0, 2.5, -70.0 / 27.0, 35.0 / 27.0},
+               {1631.0 / 55296.0, 175.0 / 512.0, 575.0 / 13824.0,
+                44275.0 / 110592.0, 253.0 / 4096.0}};
+
+         /// Weights of fifth-order solution.
+         static double constexpr b[stages] = {37.0 / 378.0, 0.0,
+                                              250.0 / 621.0, 125.0 / 594.0,
+                                              0.0,           512.0 / 1771.0};
+
+         /// Difference between fifth- and fourth-order weights.
+         static double constexpr e[estimates][stages] = {
+               {b[0] - 2825.0 / 27648.0, 0.0, b[2] - 18575.0 / 48384.0,
+                b[3] - 13525.0 / 55296.0, -277.0 / 14336.0, b[5] - 0.25}};
+
+         /// \return  Absolute value of the single estimate.
+         template <typename R>
+         static double error(
+               /// Function returning ratio of error to scale for row of
+               /// \a e.
+               R const &r)
+         {
+            return std::fabs(r(0));
+         }
+      };
+
+      template <typename V>
+      double constexpr basic_cash_karp<V>::c[];
+
+      template <typename V>
+      double constexpr basic_cash_karp<V>::a[][basic_cash_karp<V>::stages];
+
+      template <typename V>
+      double constexpr basic_cash_karp<V>::b[];
+
+      template <typename V>
+      double constexpr basic_cash_karp<V>::e[][basic_cash_karp<V>::stages];
+
+      /// Tableau of Cash and Karp.
+      using cash_karp = basic_cash_karp<>;
+
+      /// Fifth-order method DOPRI5(4) of Dormand and Prince, with embedded
+      /// fourth-order estimate of error (Hairer, Norsett, and Wanner,
+      /// Solving Ordinary Differential Equations I, Second Edition, Page
+      /// 178).  The seventh stage is evaluated on the new state, and so,
+      /// for rk_ode, it is the first stage of the next step; each step costs
+      /// six evaluations.
+      template <typename = void>
+      struct basic_dopri5
+      {
+         static unsigned constexpr stages    = 7;    ///< Stages.
+         static unsigned constexpr order     = 4;    ///< Order of estimate.
+         static bool constexpr     fsal      = true; ///< FSAL.
+         static unsigned constexpr estimates = 1;    ///< Rows of \a e.
+
+         /// Nodes.
+         static double constexpr c[stages] = {
+               0.0, 0.2, 0.3, 0.8, 8.0 / 9.0, 1.0, 1.0};
+
+         /// Coefficients of earlier stages in each stage.
+         static double constexpr a[stages][stages] = {
+               {},
+               {0.2},
+               {3.0 / 40.0, 9.0 / 40.0},
+               {44.0 / 45.0, -56.0 / 15.0, 32.0 / 9.0},
+               {19372.0 / 6561.0, -25360.0 / 2187.0, 64448.0 / 6561.0,
+                -212.0 / 729.0},
+               {9017.0 / 3168.0, -355.0 / 33.0, 46732.0 / 5247.0,
+                49.0 / 176.0, -5103.0 / 18656.0},
+               {35.0 / 384.0, 0.0, 500.0 / 1113.0, 125.0 / 192.0,
+                -2187.0 / 6784.0, 11.0 / 84.0}};
+
+         /// Weights of fifth-order solution, the same as the last row of \a
+         /// a.
+         static double constexpr b[stages] = {
+               35.0 / 384.0,     0.0,          500.0 / 1113.0, 125.0 / 192.0,
+               -2187.0 / 6784.0, 11.0 / 84.0, 0.0};
+
+         /// Difference between fifth- and fourth-order weights.
+         static double constexpr e[estimates][stages] = {
+               {71.0 / 57600.0, 0.0, -71.0 / 16695.0, 71.0 / 1920.0,
+                -17253.0 / 339200.0, 22.0 / 525.0, -1.0 / 40.0}};
+
+         /// \return  Absolute value of the single estimate.
+         template <typename R>
+         static double error(
+               /// Function returning ratio of error to scale for row of
+               /// \a e.
+               R const &r)
+         {
+            return std::fabs(r(0));
+         }
+      };
+
+      template <typename V>
+      double constexpr basic_dopri5<V>::c[];
+
+      template <typename V>
+      double constexpr basic_dopri5<V>::a[][basic_dopri5<V>::stages];
+
+      template <typename V>
+      double constexpr basic_dopri5<V>::b[];
+
+      template <typename V>
+      double constexpr basic_dopri5<V>::e[][basic_dopri5<V>::stages];
+
+      /// Tableau of Dormand and Prince, order five.
+      using dopri5 = basic_dopri5<>;
+
+      /// Eighth-order method DOP853 of Dormand and Prince, with embedded
+      /// fifth- and third-order estimates of error combined as in Hairer's
+      /// code DOP853 (Hairer, Norsett, and Wanner, Solving Ordinary
+      /// Differential Equations I, Second Edition, Page 254).  The
+      /// coefficients are those of Hairer's code.  There are twelve stages
+      /// and a thirteenth, evaluated on the new state, that is the first
+      /// stage of the next step.  For a smooth function at a tight
+      /// tolerance, this takes far fewer evaluations than cash_karp.
+      template <typename = void>
+      struct basic_dop853
+      {
+         static unsigned constexpr stages    = 13;   ///< Stages.
+         static unsigned constexpr order     = 7;    ///< Order of estimate.
+         static bool constexpr     fsal      = true; ///< FSAL.
+         static unsigned constexpr estimates = 2;    ///< Rows of \a e.
+
+         /// Nodes.
+         static double constexpr c[stages] = {
+               0.0, 0.526001519587677318785587544488e-01,
+               0.789002279381515978178381316732e-01,
+               0.118350341907227396726757197510,
+               0.281649658092772603273242802490,
+               0.333333333333333333333333333333, 0.25,
+               0.307692307692307692307692307692,
+               0.651282051282051282051282051282, 0.6,
+               0.857142857142857142857142857142, 1.0, 1.0};
+
+         /// Weights of eighth-order solution, the same as the last row of
+         /// \a a.
+         static double constexpr b[stages] = {
+               5.42937341165687622380535766363e-2, 0.0, 0.0, 0.0, 0.0,
+               4.45031289275240888144113950566,
+               1.89151789931450038304281599044,
+               -5.8012039600105847814672114227,
+               3.1116436695781989440891606237e-1,
+               -1.52160949662516078556178806805e-1,
+               2.01365400804030348374776537501e-1,
+               4.47106157277725905176885569043e-2, 0.0};
+
+         /// Coefficients of earlier stages in each stage.
+         static double constexpr a[stages][stages] = {
+               {},
+               {5.26001519587677318785587544488e-2},
+               {1.97250569845378994544595329183e-2,
+                5.91751709536136983633785987549e-2},
+               {2.95875854768068491816892993775e-2, 0.0,
+                8.87627564304205475450678981324e-2},
+               {2.41365134159266685502369798665e-1, 0.0,
+                -8.84549479328286085344864962717e-1,
+                9.24834003261792003115737966543e-1},
+               {3.7037037037037037037037037037e-2, 0.0, 0.0,
+                1.70828608729473871279604482173e-1,
+                1.25467687566822425016691814123e-1},
+               {3.7109375e-2, 0.0, 0.0, 1.70252211019544039314978060272e-1,
+                6.02165389804559606850219397283e-2, -1.7578125e-2},
+               {3.70920001185047927108779319836e-2, 0.0, 0.0,
+                1.70383925712239993810214054705e-1,
+                1.07262030446373284651809199168e-1,
+                -1.53194377486244017527936158236e-2,
+                8.27378916381402288758473766002e-3},
+               {6.24110958716075717114429577812e-1, 0.0, 0.0,
+                -3.36089262944694129406857109825,
+                -8.68219346841726006818189891453e-1,
+                2.75920996994467083049415600797e1,
+                2.01540675504778934086186788979e1,
+                -4.34898841810699588477366255144e1},
+               {4.77662536438264365890433908527e-1, 0.0, 0.0,
+                -2.48811461997166764192642586468,
+                -5.90290826836842996371446475743e-1,
+                2.12300514481811942347288949897e1,
+                1.52792336328824235832596922938e1,
+                -3.32882109689848629194453265587e1,
+                -2.03312017085086261358222928593e-2},
+               {-9.3714243008598732571704021658e-1, 0.0, 0.0,
+                5.18637242884406370830023853209,
+                1.09143734899672957818500254654,
+                -8.14978701074692612513997267357,
+                -1.85200656599969598641566180701e1,
+                2.27394870993505042818970056734e1,
+                2.49360555267965238987089396762,
+                -3.0467644718982195003823669022},
+               {2.27331014751653820792359768449, 0.0, 0.0,
+                -1.05344954667372501984066689879e1,
+                -2.00087205822486249909675718444,
+                -1.79589318631187989172765950534e1,
+                2.79488845294199600508499808837e1,
+                -2.85899827713502369474065508674,
+                -8.87285693353062954433549289258,
+                1.23605671757943030647266201528e1,
+                6.43392746015763530355970484046e-1},
+               {5.42937341165687622380535766363e-2, 0.0, 0.0, 0.0, 0.0,
+                4.45031289275240888144113950566,
+                1.89151789931450038304281599044,
+                -5.8012039600105847814672114227,
+                3.1116436695781989440891606237e-1,
+                -1.52160949662516078556178806805e-1,
+                2.01365400804030348374776537501e-1,
+                4.47106157277725905176885569043e-2}};
+
+         /// Weights for the fifth-order estimate (first row) and the
+         /// third-order estimate (second row).
+         static double constexpr e[estimates][stages] = {
+               {0.1312004499419488073250102996e-1, 0.0, 0.0, 0.0, 0.0,
+                -0.1225156446376204440720569753e+1,
+                -0.4957589496572501915214079952,
+                0.1664377182454986536961530415e+1,
+                -0.3503288487499736816886487290,
+                0.3341791187130174790297318841,
+                0.8192320648511571246570742613e-1,
+                -0.2235530786388629525884427845e-1},
+               {b[0] - 0.244094488188976377952755905512, b[1], b[2], b[3],
+                b[4], b[5], b[6], b[7],
+                b[8] - 0.733846688281611857341361741547, b[9], b[10],
+                b[11] - 0.220588235294117647058823529412e-1}};
+
+         /// The fifth-order estimate \f$ r_5 \f$ is scaled by the
+         /// third-order estimate \f$ r_3 \f$, as
+         /// \f$ r_5^2 / \sqrt{r_5^2 + 0.01 r_3^2} \f$, so that the error
+         /// scales as \f$ h^8 \f$.
+         ///
+         /// \return  Combined estimate.
+         template <typename R>
+         static double error(
+               /// Function returning ratio of error to scale for row of
+               /// \a e.
+               R const &r)
+         {
+            double const r5 = r(0);
+            double const r3 = r(1);
+            double const d  = r5 * r5 + 0.01 * r3 * r3;
+            return d > 0.0 ? r5 * r5 / std::sqrt(d) : 0.0;
+         }
+      };
+
+      template <typename V>
+      double constexpr basic_dop853<V>::c[];
+
+      template <typename V>
+      double constexpr basic_dop853<V>::a[][basic_dop853<V>::stages];
+
+      template <typename V>
+      double constexpr basic_dop853<V>::b[];
+
+      template <typename V>
+      double constexpr basic_dop853<V>::e[][basic_dop853<V>::stages];
+
+      /// Tableau of Dormand and Prince, order eight.
+      using dop853 = basic_dop853<>;
+   }
+}
+
+#endif // ndef NUMERIC_TABLEAU_HPP
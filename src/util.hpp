@@ -10,6 +10,8 @@
 #ifndef NUMERIC_UTIL_HPP
 #define NUMERIC_UTIL_HPP
 
+#include <type_traits> // for decay
+
 namespace num
 {
    /// Type of ratio of two tings.
@@ -24,6 +26,85 @@ namespace num
    template <typename X, typename Y>
    using PRD = decltype(X() * Y());
 
+   /// Helper for SFINAE: void if every type be well formed.
+   template <typename... T>
+   struct always_void
+   {
+      using type = void; ///< Always void.
+   };
+
+   /// Type of argument of a callable of one argument.  The member \a type is
+   /// defined for a function, a pointer to function, and an object, such as
+   /// a lambda, with a single, non-template operator(); otherwise, there is
+   /// no member, so that an overload depending on it is merely discarded.
+   ///
+   /// \tparam F  Type of callable.
+   template <typename F, typename = void>
+   struct arg_of
+   {
+   };
+
+   /// Type of argument of an object with a single operator().
+   template <typename F>
+   struct arg_of<F, typename always_void<decltype(&F::operator())>::type>
+         : arg_of<decltype(&F::operator())>
+   {
+   };
+
+   /// Type of argument of a function.
+   template <typename R, typename A>
+   struct arg_of<R(A)>
+   {
+      using type = typename std::decay<A>::type; ///< Argument.
+   };
+
+   /// Type of argument of a pointer to function.
+   template <typename R, typename A>
+   struct arg_of<R (*)(A)> : arg_of<R(A)>
+   {
+   };
+
+   /// Type of argument of a non-const operator().
+   template <typename R, typename C, typename A>
+   struct arg_of<R (C::*)(A)> : arg_of<R(A)>
+   {
+   };
+
+   /// Type of argument of a const operator().
+   template <typename R, typename C, typename A>
+   struct arg_of<R (C::*)(A) const> : arg_of<R(A)>
+   {
+   };
+
+   /// Type of argument of a callable of one argument.
+   /// \tparam F  Type of callable.
+   template <typename F>
+   using ARG = typename arg_of<F>::type;
+
+   /// Compile-time list of indices, for expanding a parameter pack over the
+   /// elements of an array or the axes of a grid.  (C++11 lacks
+   /// std::index_sequence.)
+   ///
+   /// \tparam K  Indices.
+   template <unsigned... K>
+   struct index_list
+   {
+   };
+
+   /// Make index_list<0, 1, ..., N-1> as member type.
+   /// \tparam N  Number of indices.
+   template <unsigned N, unsigned... K>
+   struct make_index_list : make_index_list<N - 1, N - 1, K...>
+   {
+   };
+
+   /// Final step in making index_list.
+   template <unsigned... K>
+   struct make_index_list<0, K...>
+   {
+      using type = index_list<K...>; ///< List of indices.
+   };
+
    /// Integer-template power of a double.
    /// \tparam P  Exponent.
    template <int P>
@@ -0,0 +1,299 @@
+
+// Copyright 2016-2017  Thomas E. Vaughan
+//
+// This software is distributable under the terms of the GNU LGPL, Version 3 or
+// later.
+
+/// \file   warped-table.hpp
+/// \brief  Definition of num::warped_table and num::make_warped_table().
+
+#ifndef NUMERIC_WARPED_TABLE_HPP
+#define NUMERIC_WARPED_TABLE_HPP
+
+#include <algorithm>  // for max(), min()
+#include <cmath>      // for cos(), exp(), fabs(), log()
+#include <cstdint>    // for int64_t
+#include <cstring>    // for memcpy()
+#include <functional> // for function
+#include <utility>    // for move()
+#include <vector>     // for vector
+
+#include <poly.hpp> // for cheb_cubic(), poly
+
+namespace num
+{
+   /// Transform of argument for warped_table: the natural logarithm.
+   struct log_warp
+   {
+      /// \return  \f$ \ln a \f$.
+      double operator()(/** Argument. */ double a) const
+      {
+         return std::log(a);
+      }
+
+      /// \return  \f$ e^u \f$.
+      double inv(/** Transformed argument. */ double u) const
+      {
+         return std::exp(u);
+      }
+   };
+
+   /// Transform of argument for warped_table: a piecewise-linear
+   /// approximation to \f$ \log_2 a \f$, computed from the bits of a
+   /// positive, normal double.
+   ///
+   /// If \f$ a = m \, 2^e \f$, where \f$ 1 \le m < 2 \f$, then the
+   /// transform is \f$ e + m - 1 \f$.  That is exactly the integer formed by
+   /// the bits of \f$ a \f$, scaled by \f$ 2^{-52} \f$, less the bias 1023, so
+   /// it costs one conversion and one multiplication, with no call to log().
+   /// The transform is continuous, nondecreasing (up to the rounding of the
+   /// integer to double, which discards at most its low eleven bits), and
+   /// within 0.09 of \f$ \log_2 a \f$.  With \f$ k \f$ sub-domains per unit
+   /// of the transform, each octave \f$ [2^e, 2^{e+1}) \f$ is split into
+   /// \f$ k \f$ sub-domains of equal length, and so the length of each
+   /// sub-domain is between \f$ 1/k \f$ and \f$ 2/k \f$ of its distance from
+   /// zero.
+   struct fast_log2_warp
+   {
+      /// \return  \f$ e + m - 1 \f$.
+      double operator()(/** Argument. */ double a) const
+      {
+         int64_t b;
+         std::memcpy(&b, &a, sizeof(b));
+         return b * (1.0 / 4503599627370496.0) - 1023.0;
+      }
+
+      /// \return  Argument \f$ a \f$ whose transform is \f$ u \f$.
+      double inv(/** Transformed argument. */ double u) const
+      {
+         int64_t const b = (u + 1023.0) * 4503599627370496.0;
+         double        a;
+         std::memcpy(&a, &b, sizeof(a));
+         return a;
+      }
+   };
+
+   /// A piecewise function whose sub-domains are of common length in a
+   /// transformed argument \f$ u = w(a) \f$ rather than in the argument
+   /// \f$ a \f$ itself, so that lookup takes constant time, as in
+   /// dense_table, but the sub-domains can be spaced logarithmically.
+   ///
+   /// For a function spanning several decades, such as a spectrum or a cross
+   /// section, a dense_table would need sub-domains short enough for the
+   /// smallest scale everywhere, and so almost all of them would be wasted.
+   /// With \f$ w \f$ logarithmic, each sub-domain has a length proportional
+   /// to its distance from zero, and so the number of sub-domains grows only
+   /// with the number of decades.
+   ///
+   /// The transform \a W must be strictly increasing and provide its inverse
+   /// as member function inv().  The boundary of sub-domain \f$ i \f$ is
+   /// \f$ b_i = w^{-1}(u_0 + i \Delta u) \f$, except that \f$ b_0 \f$ and
+   /// \f$ b_n \f$ are exactly the ends of the domain, and its center is
+   /// \f$ a_i = (b_i + b_{i+1})/2 \f$.  As in dense_table, the sub-function
+   /// \f$ f_i \f$ takes the offset \f$ a - a_i \f$.  The offset \f$ i \f$
+   /// is the integer truncation of \f$ (w(a) - u_0) / \Delta u \f$, clamped
+   /// to the table.  If \f$ a < b_0 \f$ or \f$ a > b_n \f$, then zero is
+   /// returned.
+   ///
+   /// Because both transforms provided here are logarithmic, every argument,
+   /// and so the whole domain, must be positive.
+   ///
+   /// The default transform, fast_log2_warp, extracts the index from the
+   /// exponent and leading bits of the mantissa without calling log().  A
+   /// table of polynomial sub-functions can be made from a function by
+   /// make_warped_table().
+   ///
+   /// \tparam F  Type of each sub-function \f$ f_i \f$ in the table.
+   /// \tparam W  Type of transform \f$ w \f$.
+   template <typename F, typename W = fast_log2_warp>
+   class warped_table
+   {
+      W                   w_;   ///< Transform of argument.
+      double              u0_;  ///< Transform \f$ u_0 \f$ of first boundary.
+      double              du_;  ///< Length of sub-domain in transform.
+      double              idu_; ///< Inverse of length in transform.
+      std::vector<double> b_;   ///< Boundaries of sub-domains.
+      std::vector<double> a_;   ///< Centers of sub-domains.
+      std::vector<F>      f_;   ///< Table of sub-functions.
+
+      /// Offset of sub-domain containing \a a, clamped to the table.
+      unsigned find(/** Argument to function. */ double a) const
+      {
+         double u = (w_(a) - u0_) * idu_;
+         u        = std::min(std::max(u, 0.0), double(f_.size() - 1));
+         return u;
+      }
+
+   public:
+      /// Initialize members from the ends of the domain, which is split into
+      /// as many sub-domains as there are sub-functions.  The first and last
+      /// boundaries are exactly \a aa and \a bb, rather than the result of
+      /// the round trip through \f$ w \f$ and its inverse, which might lose
+      /// the low bits, so that each end of the domain is in the table.
+      warped_table(
+            /** Beginning of domain (positive). */ double aa,
+            /** End of domain.                  */ double bb,
+            /// Sub-function objects.  The first sub-function in \a vf is
+            /// interpreted as \f$ f_0 \f$, the second as \f$ f_1 \f$, etc.
+            std::vector<F> vf,
+            /** Transform of argument.          */ W const &w = W())
+         : w_(w), f_(std::move(vf))
+      {
+         if (f_.size() < 1) {
+            throw "warped_table must have at least one record.";
+         }
+         if (!(aa > 0.0)) {
+            throw "Domain must be positive.";
+         }
+         if (!(bb > aa)) {
+            throw "End of domain must follow beginning.";
+         }
+         unsigned const n = f_.size();
+         u0_              = w_(aa);
+         du_              = (w_(bb) - u0_) / n;
+         idu_             = 1.0 / du_;
+         b_.resize(n + 1);
+         a_.resize(n);
+         b_[0] = aa;
+         for (unsigned i = 1; i < n; ++i) {
+            b_[i] = w_.inv(u0_ + i * du_);
+         }
+         b_[n] = bb;
+         for (unsigned i = 0; i < n; ++i) {
+            a_[i] = 0.5 * (b_[i] + b_[i + 1]);
+         }
+      }
+
+      /// Transform \f$ u_0 \f$ of beginning of first sub-domain.
+      double u_frst() const { return u0_; }
+
+      /// Length \f$ \Delta u \f$ of each sub-domain in transform.
+      double du() const { return du_; }
+
+      /// Boundaries \f$ b_0, b_1, \ldots, b_n \f$ of sub-domains.
+      std::vector<double> const &bounds() const { return b_; }
+
+      /// Centers \f$ a_0, a_1, \ldots, a_{n-1} \f$ of sub-domains.
+      std::vector<double> const &centers() const { return a_; }
+
+      /// List of sub-functions \f$ f_0, f_1, \ldots, f_{n-1} \f$.
+      std::vector<F> const &f() const { return f_; }
+
+      /// Type of value returned by every sub-function.
+      using R = decltype(F()(0.0));
+
+      /// Find the offset \f$ i \f$ of the sub-domain containing the argument
+      /// \f$ a \f$, and return \f$ f_i(a - a_i) \f$.  If \f$ a < b_0 \f$, or
+      /// \f$ a > b_n \f$, then return 0.
+      ///
+      /// \return \f$ f_i(a - a_i) \f$.
+      R operator()(/** Argument to function. */ double a) const
+      {
+         if (a < b_.front() || a > b_.back()) {
+            return R();
+         }
+         unsigned const i = find(a);
+         return f_[i](a - a_[i]);
+      }
+
+      /// Evaluate function at each argument in [\a first, \a last), and write
+      /// each result, as by operator()(), to the corresponding element of
+      /// the range beginning at \a out.  As in dense_table::val(), the offset
+      /// is clamped rather than tested, and each argument outside the domain
+      /// is masked to zero after evaluation.
+      ///
+      /// \return  Iterator past last result written.
+      template <typename II, typename OI>
+      OI val(
+            /** Iterator to first argument.  */ II first,
+            /** Iterator past last argument. */ II last,
+            /** Iterator to first result.    */ OI out) const
+      {
+         double const lo = b_.front();
+         double const hi = b_.back();
+         for (; first != last; ++first, ++out) {
+            double const   a = *first;
+            bool const     in = !(a < lo || a > hi);
+            unsigned const i  = find(in ? a : lo);
+            R const        r  = f_[i](a - a_[i]);
+            *out              = in ? r : R();
+         }
+         return out;
+      }
+   };
+
+   /// Make a warped_table of cubic sub-functions that approximates a
+   /// function.
+   ///
+   /// Starting from \a n sub-domains of common length in the transform \a w,
+   /// on each sub-domain, the cubic that interpolates \a g at the four
+   /// Chebyshev nodes is formed by cheb_cubic(), and the error is estimated
+   /// at the five extrema of the Chebyshev polynomial of degree four, where
+   /// the error of such an interpolant peaks.  The number of sub-domains is
+   /// doubled until the error nowhere exceed the tolerance.  If the tolerance
+   /// be not met with \a max_n sub-domains, then an exception is thrown.
+   ///
+   /// \tparam W  Type of transform.
+   ///
+   /// \return  Table approximating \a g over [\a aa, \a bb].
+   template <typename W = fast_log2_warp>
+   warped_table<poly<3>, W> make_warped_table(
+         /// Function to approximate.
+         std::function<double(double)> const &g,
+         /// Beginning of domain, which must be positive.
+         double aa,
+         /// End of domain.
+         double bb,
+         /// Tolerance on error.
+         double tol,
+         /// True if \a tol be relative to \f$ |g(a)| \f$ at each \f$ a \f$,
+         /// as is usual for a function spanning several decades.
+         bool rel = false,
+         /// Transform.
+         W const &w = W(),
+         /// Initial number of sub-domains.
+         unsigned n = 16,
+         /// Maximum number of sub-domains.
+         unsigned max_n = 1u << 24)
+   {
+      if (!(bb > aa)) {
+         throw "End of domain must follow beginning.";
+      }
+      if (!(aa > 0.0)) {
+         throw "Domain must be positive.";
+      }
+      if (!(tol > 0.0)) {
+         throw "Tolerance must be positive.";
+      }
+      double const pi = 3.14159265358979323846;
+      double const u0 = w(aa);
+      for (; n <= max_n; n *= 2) {
+         double const         du = (w(bb) - u0) / n;
+         double               bl = aa; // Beg of sub-domain.
+         bool                 ok = true;
+         std::vector<poly<3>> f(n);
+         for (unsigned i = 0; i < n && ok; ++i) {
+            // End of sub-domain, as in warped_table.
+            double const br = (i + 1 < n ? w.inv(u0 + (i + 1) * du) : bb);
+            double const c  = 0.5 * (bl + br);
+            double const h  = br - bl;
+            f[i]            = cheb_cubic(g, c, h);
+            for (unsigned k = 0; k <= 4 && ok; ++k) {
+               double const t = 0.5 * h * std::cos(k * pi / 4.0);
+               double const y = g(c + t);
+               ok = std::fabs(f[i](t) - y) <= (rel ? tol * std::fabs(y) : tol);
+            }
+            bl = br;
+         }
+         if (ok) {
+            return warped_table<poly<3>, W>(aa, bb, std::move(f), w);
+         }
+         if (n > max_n / 2) {
+            break; // Doubling would exceed max_n or overflow.
+         }
+      }
+      throw "Tolerance not met by warped table.";
+   }
+}
+
+#endif // ndef NUMERIC_WARPED_TABLE_HPP
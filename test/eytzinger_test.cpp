@@ -0,0 +1,32 @@
+
+// Copyright 2016-2017  Thomas E. Vaughan
+//
+// This software is distributable under the terms of the GNU LGPL, Version 3 or
+// later.
+
+#include <algorithm> // for sort(), upper_bound()
+#include <random>    // for mt19937
+
+#include "catch.hpp"
+#include "eytzinger.hpp"
+
+using namespace num;
+using namespace std;
+
+TEST_CASE("Verify that eytzinger agrees with upper_bound.", "[eytzinger]")
+{
+   mt19937 gen(1);
+   for (unsigned n = 0; n < 100; ++n) {
+      vector<double> keys(n);
+      for (auto &k : keys) {
+         k = gen() % 50; // Include duplicate keys.
+      }
+      sort(keys.begin(), keys.end());
+      eytzinger<double> const e(keys);
+      REQUIRE(e.size() == n);
+      for (double a = -1.0; a < 51.0; a += 0.5) {
+         auto const u = upper_bound(keys.begin(), keys.end(), a);
+         REQUIRE(e.count(a) == unsigned(u - keys.begin()));
+      }
+   }
+}
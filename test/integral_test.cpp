@@ -4,6 +4,8 @@
 // This software is distributable under the terms of the GNU LGPL, Version 3 or
 // later.
 
+#include <array>   // for array
+#include <chrono>  // for steady_clock
 #include <sstream> // for ostringstream
 
 #include "catch.hpp"
@@ -76,6 +78,174 @@ TEST_CASE("Verify integration of member function (via lambda).", "[integral]")
    REQUIRE(m == Approx(0.0));
 }
 
+TEST_CASE("Verify integration of lambda without std::function.",
+          "[integral]")
+{
+   auto const f = [](double x) { return 1.0 / (1.0 + x * x); };
+   function<double(double)> const g = f;
+   // Same arithmetic, so same result, whether or not through std::function.
+   REQUIRE(integral(f, -4.0, +4.0) == integral(g, -4.0, +4.0));
+   REQUIRE(rk_quadd(f, -4.0, +4.0).def_int() == integral(g, -4.0, +4.0));
+   REQUIRE(integral(f, -4.0, +4.0, 1.0E-09) ==
+           Approx(2.0 * atan(4.0)).epsilon(1.0E-08));
+   // Lower limit of different type.
+   REQUIRE(integral(f, 0, 1.0) == Approx(0.25 * M_PI));
+   my_sin s(2.0);
+   auto const h = [&s](double x) { return s.sin(x); };
+   REQUIRE(integral(h, 0, M_PI) == Approx(0.0));
+   REQUIRE(integral([](length x) { return x * x; }, 0 * cm, 1 * cm) /
+                 pow<3>(cm) ==
+           Approx(1.0 / 3.0));
+}
+
+/// Integrand that can evaluate a batch of abscissae at once.
+struct batch_lorentz
+{
+   mutable unsigned nb = 0; ///< Number of calls with batch.
+   double operator()(double x) const { return 1.0 / (1.0 + x * x); }
+   array<double, rk_batch> operator()(array<double, rk_batch> const &x) const
+   {
+      ++nb;
+      array<double, rk_batch> y;
+      for (unsigned i = 0; i < rk_batch; ++i) {
+         y[i] = 1.0 / (1.0 + x[i] * x[i]);
+      }
+      return y;
+   }
+};
+
+TEST_CASE("Verify integration of vectorized integrand.", "[integral]")
+{
+   batch_lorentz const f;
+   auto const g = [](double x) { return 1.0 / (1.0 + x * x); };
+   using tf = takes_batch<batch_lorentz, double, double>;
+   using tg = takes_batch<decltype(g), double, double>;
+   using th = takes_batch<function<double(double)>, double, double>;
+   REQUIRE(tf::value);
+   REQUIRE(!tg::value);
+   REQUIRE(!th::value);
+   // Same arithmetic, so same result.
+   REQUIRE(integral<double>(f, -4.0, +4.0) == integral(g, -4.0, +4.0));
+   REQUIRE(f.nb > 0);
+   unsigned const nb = f.nb;
+   REQUIRE(rk_quadd(f, -4.0, +4.0).def_int() == integral(g, -4.0, +4.0));
+   REQUIRE(f.nb == 2 * nb);
+}
+
+TEST_CASE("Verify parallel integration.", "[integral]")
+{
+   // Narrow peak, near which pieces exceed a small budget and are split.
+   auto const f = [](double x) {
+      double const u = (x - 0.3) / 1.0E-03;
+      return 1.0 / (1.0 + u * u);
+   };
+   double const e = 1.0E-03 * (atan(0.7E+03) + atan(0.3E+03));
+   double const p = par_integral(f, 0.0, 1.0, 1.0E-08, 1, 16, 64);
+   REQUIRE(p == Approx(e).epsilon(1.0E-06));
+   // Same result, bit for bit, whatever the number of threads.
+   for (unsigned nt : {2u, 3u, 8u}) {
+      REQUIRE(par_integral(f, 0.0, 1.0, 1.0E-08, nt, 16, 64) == p);
+   }
+   REQUIRE(par_integral(f, 0.0, 1.0) == Approx(e).epsilon(1.0E-05));
+   REQUIRE(par_integral(f, 1.0, 0.0, 1.0E-08, 4) ==
+           Approx(-e).epsilon(1.0E-06));
+   REQUIRE(par_integral(square1, 0 * cm, 1 * cm, 1.0E-06, 4) / pow<3>(cm) ==
+           Approx(1.0 / 3.0));
+   // Exception from any piece reaches caller.
+   auto const bad = [](double x) -> double {
+      if (x > 0.5) {
+         throw "bad argument";
+      }
+      return x;
+   };
+   REQUIRE_THROWS(par_integral(bad, 0.0, 1.0, 1.0E-06, 4));
+}
+
+TEST_CASE("Verify general Runge-Kutta integrator.", "[integral]")
+{
+   // Harmonic oscillator, y'' = -y, with state of fixed size.
+   using S2 = array<double, 2>;
+   auto const f = [](double, S2 const &y, S2 &dydx) {
+      dydx[0] = +y[1];
+      dydx[1] = -y[0];
+   };
+   rk_ode<S2> o(0.0, S2{{1.0, 0.0}}, 1.0E-10);
+   for (double x = 0.5; x <= 10.0; x += 0.5) {
+      o.integrate(f, x);
+      REQUIRE(o.x() == x);
+      REQUIRE(o.y()[0] == Approx(+cos(x)).epsilon(1.0E-08));
+      REQUIRE(o.y()[1] == Approx(-sin(x)).epsilon(1.0E-08));
+   }
+   REQUIRE(o.nok() + o.nbad() > 0);
+   o.integrate(f, 0.0); // Backward.
+   REQUIRE(o.y()[0] == Approx(1.0).epsilon(1.0E-08));
+   REQUIRE(fabs(o.y()[1]) < 1.0E-07);
+
+   // Independent decays, y_i' = -(i+1) y_i, with state of dynamic size.
+   using SV = vector<double>;
+   auto const g = [](double, SV const &y, SV &dydx) {
+      for (unsigned i = 0; i < y.size(); ++i) {
+         dydx[i] = -(i + 1.0) * y[i];
+      }
+   };
+   rk_ode<SV> d(0.0, SV(5, 1.0));
+   d.integrate(g, 2.0);
+   REQUIRE(d.y().size() == 5);
+   for (unsigned i = 0; i < 5; ++i) {
+      REQUIRE(d.y()[i] == Approx(exp(-2.0 * (i + 1.0))).epsilon(1.0E-05));
+   }
+   REQUIRE_THROWS(rk_ode<SV>(0.0, SV(1, 1.0), -1.0E-06));
+}
+
+TEST_CASE("Verify choice of Butcher tableau.", "[integral]")
+{
+   using ck = rk_quad<double, double>;
+   using d5 = rk_quad<double, double, tableau::dopri5>;
+   using d8 = rk_quad<double, double, tableau::dop853>;
+   REQUIRE(ck::batch == rk_batch);
+   REQUIRE(d5::batch == 4);
+   REQUIRE(d8::batch == 7);
+
+   // Smooth integrand at tight tolerance.
+   unsigned   n = 0; // Number of evaluations.
+   auto const f = [&n](double x) {
+      ++n;
+      return exp(x) * cos(x);
+   };
+   double const e = 0.5 * (exp(4.0) * (cos(4.0) + sin(4.0)) - 1.0);
+   double const t = 1.0E-12;
+   REQUIRE(ck(f, 0.0, 4.0, t).def_int() == Approx(e).epsilon(1.0E-10));
+   unsigned const n_ck = n;
+   n                   = 0;
+   REQUIRE(d5(f, 0.0, 4.0, t).def_int() == Approx(e).epsilon(1.0E-10));
+   n = 0;
+   REQUIRE(d8(f, 0.0, 4.0, t).def_int() == Approx(e).epsilon(1.0E-10));
+   REQUIRE(n < n_ck / 2);
+
+   // Harmonic oscillator.
+   using S2 = array<double, 2>;
+   auto const g = [&n](double, S2 const &y, S2 &dydx) {
+      ++n;
+      dydx[0] = +y[1];
+      dydx[1] = -y[0];
+   };
+   n = 0;
+   rk_ode<S2> o_ck(0.0, S2{{1.0, 0.0}}, t);
+   o_ck.integrate(g, 10.0);
+   unsigned const m_ck = n;
+   n                   = 0;
+   rk_ode<S2, tableau::dopri5> o_d5(0.0, S2{{1.0, 0.0}}, t);
+   o_d5.integrate(g, 10.0);
+   n = 0;
+   rk_ode<S2, tableau::dop853> o_d8(0.0, S2{{1.0, 0.0}}, t);
+   o_d8.integrate(g, 10.0);
+   REQUIRE(n < m_ck / 2);
+   for (auto const &y : {o_ck.y(), o_d5.y(), o_d8.y()}) {
+      REQUIRE(y[0] == Approx(+cos(10.0)).epsilon(1.0E-09));
+      REQUIRE(y[1] == Approx(-sin(10.0)).epsilon(1.0E-09));
+   }
+}
+
 double catch_epsilon(double tol)
 {
    double constexpr eps = 100.0 * numeric_limits<double>::epsilon();
@@ -148,3 +318,29 @@ TEST_CASE("Verify throw on illegal tolerance.", "[integral]")
                          .def_int()));
 }
 
+// Hidden; run with `./tests [.benchmark]`.  At -O2, with the step-size
+// control using std::pow, the lambda measured about 1.1x to 1.2x faster.
+TEST_CASE("Compare speed of integration through std::function and lambda.",
+          "[integral][.benchmark]")
+{
+   auto const f = [](double x) { return 1.0 / (1.0 + x * x); };
+   function<double(double)> const g = f;
+   using clock      = chrono::steady_clock;
+   unsigned const n = 20000;
+   double         sf = 0.0; // Sum through lambda.
+   double         sg = 0.0; // Sum through std::function.
+   auto const     t0 = clock::now();
+   for (unsigned i = 0; i < n; ++i) {
+      sg += integral(g, -4.0, +4.0 + 1.0E-06 * i, 1.0E-10);
+   }
+   auto const t1 = clock::now();
+   for (unsigned i = 0; i < n; ++i) {
+      sf += integral(f, -4.0, +4.0 + 1.0E-06 * i, 1.0E-10);
+   }
+   auto const t2 = clock::now();
+   REQUIRE(sf == sg);
+   double const dg = chrono::duration<double>(t1 - t0).count();
+   double const df = chrono::duration<double>(t2 - t1).count();
+   WARN("std::function: " << dg << " s; lambda: " << df
+                          << " s; speed-up: " << dg / df);
+}
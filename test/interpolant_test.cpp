@@ -4,11 +4,21 @@
 // This software is distributable under the terms of the GNU LGPL, Version 3 or
 // later.
 
-#include <cmath> // for erf()
+#include <cmath>   // for erf()
+#include <cstddef> // for offsetof()
+#include <cstdio>  // for remove()
+#include <fstream> // for fstream
 
 #include "catch.hpp"
+#include "fixed-dense-table.hpp"
+#include "frozen-table.hpp"
+#include "grid-table.hpp"
 #include "integral.hpp"
 #include "interpolant.hpp"
+#include "resample.hpp"
+#include "rk.hpp"
+#include "table-file.hpp"
+#include "warped-table.hpp"
 #include "units.hpp"
 
 using namespace GiNaC;
@@ -32,6 +42,114 @@ TEST_CASE("Verify interpolation on vector of points.", "[interpolant]")
    REQUIRE(j(2.00) == 0.00); // sparse_table is zero outside bounds.
 }
 
+TEST_CASE("Verify numeric evaluation of interpolant.", "[interpolant]")
+{
+   ilist<double, double> list = {{0.00, 0.00}, {0.50, 0.25}, {1.00, 1.00}};
+
+   auto j = make_linear_interp(list);
+
+   REQUIRE(j.has_pol());
+   REQUIRE(j.pol().size() == j.dat().size());
+   REQUIRE(j.val(-1.0) == 0.0);
+   REQUIRE(j.val(0.0) == Approx(0.0));
+   REQUIRE(j.val(0.25) == Approx(0.25 / 2.0));
+   REQUIRE(j.val(0.50) == Approx(0.25));
+   REQUIRE(j.val(0.75) == Approx(1.25 / 2.0));
+   REQUIRE(j.val(1.00) == Approx(1.00));
+   REQUIRE(j.val(1.01) == 0.00);
+
+   auto const k = j / j; // Quotient is not polynomial.
+
+   REQUIRE(!k.has_pol());
+   REQUIRE(k.val(0.25) == Approx(1.0));
+
+   std::function<double(double)> g = [](double x) {
+      return exp(-0.5 * x * x);
+   };
+   rk_quadd const q(g, -5.0, +5.0, 1.0E-06, 16, true);
+   auto const fi = q.make_fnc_interp();
+   auto const ii = q.make_int_interp();
+
+   REQUIRE(fi.has_pol());
+   REQUIRE(ii.has_pol());
+   for (double x = -5.5; x < 5.5; x += 0.1) {
+      REQUIRE(fi.val(x) == Approx(dbl(fi(x))));
+      REQUIRE(ii.val(x) == Approx(dbl(ii(x))));
+   }
+}
+
+TEST_CASE("Verify batch evaluation of interpolant.", "[interpolant]")
+{
+   std::function<double(double)> g = [](double x) {
+      return exp(-0.5 * x * x);
+   };
+   auto const i = make_linear_interp(g, -5.0, +5.0, 1.0E-04);
+   auto const k = i / (i + i); // Not numeric.
+
+   vector<double> sorted;
+   for (double x = -6.0; x < 6.0; x += 0.01) {
+      sorted.push_back(x);
+   }
+   vector<double> shuffled(sorted.rbegin(), sorted.rend());
+   swap(shuffled[0], shuffled[shuffled.size() / 2]);
+   vector<double> r1(sorted.size()), r2(shuffled.size()), r3(sorted.size());
+
+   REQUIRE(i.val(sorted.begin(), sorted.end(), r1.begin()) == r1.end());
+   REQUIRE(i.val(shuffled.begin(), shuffled.end(), r2.begin()) == r2.end());
+   k.val(sorted.begin(), sorted.end(), r3.begin());
+   for (unsigned j = 0; j < sorted.size(); ++j) {
+      REQUIRE(r1[j] == i.val(sorted[j]));
+      REQUIRE(r2[j] == i.val(shuffled[j]));
+      REQUIRE(r3[j] == k.val(sorted[j]));
+   }
+}
+
+TEST_CASE("Verify sequential evaluation of interpolant.", "[interpolant]")
+{
+   std::function<double(double)> g = [](double x) {
+      return exp(-0.5 * x * x);
+   };
+   auto const i = make_linear_interp(g, -5.0, +5.0, 1.0E-04);
+   auto       c = i.cur();
+
+   // Step forward, then backward, then jump.
+   for (double x = -6.0; x < 6.0; x += 0.001) {
+      REQUIRE(c.val(x) == i.val(x));
+   }
+   for (double x = 6.0; x > -6.0; x -= 0.001) {
+      REQUIRE(c.val(x) == i.val(x));
+   }
+   for (double x = -4.0; x < 4.0; x += 0.7) {
+      REQUIRE(c.val(x) == i.val(x));
+      REQUIRE(c.val(-x) == i.val(-x));
+      REQUIRE(c(x) == i(x));
+   }
+}
+
+TEST_CASE("Verify bucketed lookup in interpolant.", "[interpolant]")
+{
+   std::function<double(double)> g = [](double x) {
+      return exp(-0.5 * x * x);
+   };
+   auto const i = make_linear_interp(g, -5.0, +5.0, 1.0E-04);
+
+   REQUIRE(i.buckets() == 0);
+   REQUIRE(i.max_scan() == 0);
+   for (unsigned nb : {0u, 1u, 7u, 100u, 5000u}) {
+      auto j = i;
+      j.bucket(nb);
+      REQUIRE(j.buckets() == (nb ? nb : i.dat().size()));
+      REQUIRE(j.max_scan() <= i.dat().size());
+      for (double x = -6.0; x < 6.0; x += 0.001) {
+         REQUIRE(j.val(x) == i.val(x));
+      }
+      REQUIRE(dbl(j.integral(-1.3, 2.7)) == dbl(i.integral(-1.3, 2.7)));
+   }
+   auto j = i;
+   REQUIRE(j.bucket(1).max_scan() == i.dat().size() - 1);
+   REQUIRE(j.bucket(10 * i.dat().size()).max_scan() <= 2);
+}
+
 TEST_CASE("Verify integral of interpolant.", "[interpolant]")
 {
    ilist<double, double> list = {{0.00, 0.50}, {0.50, 1.00}, {1.00, -1.00}};
@@ -48,6 +166,633 @@ TEST_CASE("Verify integral of interpolant.", "[interpolant]")
    REQUIRE(i2.integral(+1.50, +1.25) == 0.00);
 }
 
+TEST_CASE("Verify cumulative integral of interpolant.", "[interpolant]")
+{
+   std::function<double(double)> g = [](double x) {
+      return exp(-0.5 * x * x);
+   };
+   auto const i = make_linear_interp(g, -5.0, +5.0, 1.0E-04);
+   auto       j = i;
+
+   REQUIRE(!j.cumulated());
+   j.cumulate();
+   REQUIRE(j.cumulated());
+   REQUIRE(dbl(j.integral()) == Approx(dbl(i.integral())));
+   for (double a = -6.0; a < 6.0; a += 0.37) {
+      for (double b = -6.0; b < 6.0; b += 0.41) {
+         REQUIRE(dbl(j.integral(a, b)) ==
+                 Approx(dbl(i.integral(a, b))).scale(1.0));
+      }
+   }
+   j *= 2.0;
+   REQUIRE(dbl(j.integral(-1.0, 1.0)) == Approx(2.0 * dbl(i.integral(-1, 1))));
+   j /= 4.0;
+   REQUIRE(dbl(j.integral()) == Approx(0.5 * dbl(i.integral())));
+}
+
+TEST_CASE("Verify integral over mixed sub-functions.", "[interpolant]")
+{
+   auto const &x = sparse_table_base::x;
+   using table   = sparse_table<double>;
+   table const t(1.0, {{2.0, 3.0 * x * x - x}, {2.0, 1 / x}, {2.0, 4 - x}});
+
+   REQUIRE(t.is_pol(0));
+   REQUIRE(!t.is_pol(1));
+   REQUIRE(t.is_pol(2));
+   REQUIRE(!t.has_pol());
+   REQUIRE(t.val(1.5) == Approx(5.25));
+   REQUIRE(t.val(2.5) == Approx(0.4));
+   REQUIRE(t.val(4.5) == Approx(-0.5));
+
+   // Exact integrals of pieces: 6, log(2), and -2.
+   double const l2 = log(2.0);
+   REQUIRE(dbl(t.integral()) == Approx(4.0 + l2));
+   REQUIRE(dbl(t.integral(1.0, 2.0)) == Approx(5.5));
+   REQUIRE(dbl(t.integral(2.0, 5.0)) == Approx(l2 - 0.5));
+   REQUIRE(dbl(t.integral(5.0, 2.0)) == Approx(0.5 - l2));
+
+   table c = t;
+   c.cumulate();
+   REQUIRE(dbl(c.integral()) == Approx(4.0 + l2));
+   REQUIRE(dbl(c.integral(2.0, 5.0)) == Approx(l2 - 0.5));
+   REQUIRE(dbl(c.integral(0.5, 3.0)) == Approx(6.0 + log(1.5)));
+}
+
+TEST_CASE("Verify frozen copy of interpolant.", "[interpolant]")
+{
+   std::function<double(double)> g = [](double x) {
+      return exp(-0.5 * x * x);
+   };
+   rk_quadd const q(g, -5.0, +5.0, 1.0E-06, 16, true);
+   auto const     i = q.make_int_interp();
+   frozen_table const f(i);
+
+   REQUIRE(f.size() == i.dat().size());
+   REQUIRE(f.bounds().size() == f.size() + 1);
+   vector<double> x;
+   for (double a = -6.0; a < 6.0; a += 0.01) {
+      REQUIRE(f(a) == i.val(a));
+      x.push_back(a);
+   }
+   vector<double> y(x.size());
+   f.val(x.begin(), x.end(), y.begin());
+   for (unsigned j = 0; j < x.size(); ++j) {
+      REQUIRE(y[j] == i.val(x[j]));
+   }
+   REQUIRE(f.integral() == Approx(dbl(i.integral())));
+   for (double a = -6.0; a < 6.0; a += 0.37) {
+      for (double b = -6.0; b < 6.0; b += 0.41) {
+         REQUIRE(f.integral(a, b) == Approx(dbl(i.integral(a, b))).scale(1.0));
+      }
+   }
+   REQUIRE(frozen_table().integral(0.0, 1.0) == 0.0);
+   REQUIRE_THROWS(frozen_table(i / i));
+}
+
+TEST_CASE("Verify resampling of interpolant.", "[interpolant]")
+{
+   std::function<double(double)> g = [](double x) {
+      return exp(-0.5 * x * x);
+   };
+   rk_quadd const q(g, -5.0, +5.0, 1.0E-06, 16, true);
+   auto const     fi = q.make_fnc_interp();
+   auto const     li = make_linear_interp(g, -5.0, +5.0, 1.0E-04);
+
+   for (double tol : {1.0E-03, 1.0E-06}) {
+      auto const df = make_dense_table(fi, tol);
+      auto const dl = make_dense_table(li, tol, true);
+      REQUIRE(df.a_frst() - 0.5 * df.da() == Approx(-5.0));
+      REQUIRE(df.a_last() + 0.5 * df.da() == Approx(+5.0));
+      for (double x = -5.0; x <= 5.0; x += 0.0007) {
+         REQUIRE(fabs(df(x) - fi.val(x)) <= tol);
+         REQUIRE(fabs(dl(x) - li.val(x)) <= tol);
+      }
+      REQUIRE(df(5.0) == Approx(fi.val(5.0)));
+      REQUIRE(df(5.1) == 0.0);
+   }
+   REQUIRE_THROWS(make_dense_table(li, 1.0E-12, false, 1024));
+   REQUIRE_THROWS(make_dense_table(li / li, 1.0E-03));
+}
+
+TEST_CASE("Verify batch evaluation of dense table.", "[interpolant]")
+{
+   std::function<double(double)> g = [](double x) {
+      return exp(-0.5 * x * x);
+   };
+   auto const i = make_linear_interp(g, -5.0, +5.0, 1.0E-04);
+   auto const d = make_dense_table(i, 1.0E-05);
+
+   vector<double> x;
+   for (double a = -5.3; a < 5.3; a += 0.0011) {
+      x.push_back(a);
+   }
+   x.push_back(-5.0);
+   x.push_back(+5.0);
+   vector<double> y1(x.size()), y2(x.size());
+   // Through pointers, vectorized; through iterators, not vectorized.
+   REQUIRE(d.val(x.data(), x.data() + x.size(), y1.data()) ==
+           y1.data() + y1.size());
+   REQUIRE(d.val(x.begin(), x.end(), y2.begin()) == y2.end());
+   for (unsigned j = 0; j < x.size(); ++j) {
+      REQUIRE(y1[j] == Approx(d(x[j])));
+      REQUIRE(y2[j] == Approx(d(x[j])));
+      if (x[j] < -5.0 || x[j] > 5.0) {
+         REQUIRE(y1[j] == 0.0);
+         REQUIRE(y2[j] == 0.0);
+      }
+   }
+}
+
+TEST_CASE("Verify policy for argument outside table.", "[interpolant]")
+{
+   std::function<double(double)> g = [](double x) {
+      return exp(-0.5 * x * x);
+   };
+   rk_quadd const q(g, -5.0, +5.0, 1.0E-06, 16, true);
+   auto const     i = q.make_fnc_interp();
+   auto const     d = make_dense_table(i, 1.0E-05);
+   using P         = poly<3>;
+   dense_table<double, P, outside::nan> const   dn(d.a_frst(), d.da(), d.f());
+   dense_table<double, P, outside::clamp> const dc(d.a_frst(), d.da(), d.f());
+   dense_table<double, P, outside::extrapolate> const de(
+         d.a_frst(), d.da(), d.f());
+   dense_table<double, P, outside::unchecked> const du(
+         d.a_frst(), d.da(), d.f());
+   frozen_table const f(i);
+
+   double const lo = d.a_frst() - 0.5 * d.da();
+   double const hi = d.a_last() + 0.5 * d.da();
+   vector<double> x;
+   for (double a = -5.3; a < 5.3; a += 0.0011) {
+      x.push_back(a);
+   }
+   for (double a : x) {
+      bool const in = !(a < lo || a > hi);
+      if (in) {
+         REQUIRE(dn(a) == d(a));
+         REQUIRE(dc(a) == d(a));
+         REQUIRE(de(a) == d(a));
+         REQUIRE(du(a) == d(a));
+      } else {
+         double const e = a < lo ? lo : hi; // Nearer end.
+         REQUIRE(std::isnan(dn(a)));
+         REQUIRE(dc(a) == d(e));
+         REQUIRE(de(a) == d.f()[a < lo ? 0 : d.f().size() - 1](
+                                a - (a < lo ? d.a_frst() : d.a_last())));
+      }
+      double const b = f.bounds().front();
+      double const c = f.bounds().back();
+      if (a < b || a > c) {
+         double const e = a < b ? b : c;
+         REQUIRE(f.val(a, outside::zero()) == 0.0);
+         REQUIRE(std::isnan(f.val(a, outside::nan())));
+         REQUIRE(f.val(a, outside::clamp()) == f(e));
+         REQUIRE(i.val(a, outside::clamp()) == i.val(e));
+         REQUIRE(std::isnan(i.val(a, outside::nan())));
+         REQUIRE(f.val(a, outside::extrapolate()) ==
+                 Approx(i.val(a, outside::extrapolate())));
+      } else {
+         REQUIRE(f.val(a, outside::unchecked()) == f(a));
+         REQUIRE(i.val(a, outside::unchecked()) == i.val(a));
+         REQUIRE(i.val(a, outside::extrapolate()) == i.val(a));
+      }
+   }
+
+   // Batch evaluation through pointers is vectorized.
+   vector<double> y(x.size());
+   dn.val(x.data(), x.data() + x.size(), y.data());
+   for (unsigned j = 0; j < x.size(); ++j) {
+      if (x[j] < lo || x[j] > hi) {
+         REQUIRE(std::isnan(y[j]));
+      } else {
+         REQUIRE(y[j] == Approx(d(x[j])));
+      }
+   }
+   dc.val(x.data(), x.data() + x.size(), y.data());
+   for (unsigned j = 0; j < x.size(); ++j) {
+      REQUIRE(y[j] == Approx(dc(x[j])));
+   }
+   de.val(x.data(), x.data() + x.size(), y.data());
+   for (unsigned j = 0; j < x.size(); ++j) {
+      REQUIRE(y[j] == Approx(de(x[j])));
+   }
+}
+
+TEST_CASE("Verify dense interpolant of function.", "[interpolant]")
+{
+   std::function<double(double)> g = [](double x) {
+      return exp(-0.5 * x * x);
+   };
+   double const t  = 1.0E-05;
+   auto const   d0 = make_dense_interp<0>(g, -5.0, +5.0, 1.0E-03);
+   auto const   d1 = make_dense_interp<1>(g, -5.0, +5.0, t);
+   auto const   d3 = make_dense_interp<3>(g, +5.0, -5.0, t, 16, 4);
+   auto const   d4 = make_dense_interp<3>(g, -5.0, +5.0, t, 16, 1);
+
+   REQUIRE(d3.f().size() < d1.f().size());
+   REQUIRE(d3.f().size() == d4.f().size());
+   REQUIRE(d3.a_frst() - 0.5 * d3.da() == Approx(-5.0));
+   REQUIRE(d3.a_last() + 0.5 * d3.da() == Approx(+5.0));
+   for (unsigned j = 0; j < d3.f().size(); ++j) {
+      for (unsigned k = 0; k < 4; ++k) {
+         REQUIRE(d3.f()[j].c[k] == d4.f()[j].c[k]);
+      }
+   }
+   for (double x = -5.0; x <= 5.0; x += 0.0013) {
+      REQUIRE(fabs(d0(x) - g(x)) <= 1.0E-02);
+      REQUIRE(fabs(d1(x) - g(x)) <= 10 * t);
+      REQUIRE(fabs(d3(x) - g(x)) <= 10 * t);
+   }
+   REQUIRE_THROWS(make_dense_interp<1>(g, -5.0, +5.0, 0.0));
+}
+
+namespace
+{
+   // Table of piecewise-linear function with slopes 1, 2, and 3, built and
+   // evaluated at compile time.
+   constexpr fixed_dense_table<double, poly<1>, 3> fixed_tab(
+         1.0, 2.0, poly<1>{{1.0, 1.0}}, poly<1>{{4.0, 2.0}},
+         poly<1>{{9.0, 3.0}});
+
+   static_assert(fixed_tab.size() == 3, "wrong size");
+   static_assert(fixed_tab(-0.5) == 0.0, "wrong value before domain");
+   static_assert(fixed_tab(0.5) == 0.5, "wrong value in first sub-domain");
+   static_assert(fixed_tab(3.5) == 5.0, "wrong value in second sub-domain");
+   static_assert(fixed_tab(6.0) == 12.0, "wrong value at end of domain");
+   static_assert(fixed_tab(7.5) == 0.0, "wrong value after domain");
+}
+
+TEST_CASE("Verify fixed-size dense table.", "[interpolant]")
+{
+   dense_table<double, poly<1>> const d(
+         1.0, 2.0, {poly<1>{{1.0, 1.0}}, poly<1>{{4.0, 2.0}},
+                    poly<1>{{9.0, 3.0}}});
+   for (double x = -1.0; x < 8.0; x += 0.01) {
+      REQUIRE(fixed_tab(x) == d(x));
+   }
+   REQUIRE(fixed_tab.a_last() == d.a_last());
+   REQUIRE(fixed_tab.f(1).c[0] == 4.0);
+   using fixed_1 = fixed_dense_table<double, poly<0>, 1>;
+   REQUIRE_THROWS(fixed_1(0.0, 0.0, poly<0>()));
+}
+
+TEST_CASE("Verify memory-mapped table file.", "[interpolant]")
+{
+   std::function<double(double)> g = [](double x) {
+      return exp(-0.5 * x * x);
+   };
+   rk_quadd const q(g, -5.0, +5.0, 1.0E-06, 16, true);
+   frozen_table const f(q.make_fnc_interp());
+   auto const         d = make_dense_interp<3>(g, -5.0, +5.0, 1.0E-05);
+   dim_exps const     ea(0, 1, 0, 0, 0);
+   dim_exps const     ef(1, -2, 0, 0, 0);
+
+   write_table("sparse_test.bin", f, ea, ef);
+   write_table("dense_test.bin", d);
+   mapped_table ms("sparse_test.bin");
+   mapped_table md("dense_test.bin");
+   // Mapping survives removal of file's name.
+   remove("sparse_test.bin");
+   remove("dense_test.bin");
+
+   REQUIRE(!ms.dense());
+   REQUIRE(ms.size() == f.size());
+   REQUIRE(ms.degree() == 3);
+   REQUIRE(ms.dim_a() == ea);
+   REQUIRE(ms.dim_f() == ef);
+   REQUIRE(md.dense());
+   REQUIRE(md.size() == d.f().size());
+   REQUIRE(md.dim_f() == dim_exps());
+   vector<double> x;
+   for (double a = -6.0; a < 6.0; a += 0.01) {
+      REQUIRE(ms(a) == f(a));
+      REQUIRE(md(a) == d(a));
+      x.push_back(a);
+   }
+   vector<double> y(x.size());
+   ms.val(x.begin(), x.end(), y.begin());
+   for (unsigned j = 0; j < x.size(); ++j) {
+      REQUIRE(y[j] == f(x[j]));
+   }
+   REQUIRE(ms.integral() == f.integral());
+   REQUIRE(md.integral() == Approx(sqrt(2.0 * M_PI) * erf(5.0 / sqrt(2.0))));
+   for (double a = -6.0; a < 6.0; a += 0.37) {
+      for (double b = -6.0; b < 6.0; b += 0.41) {
+         REQUIRE(ms.integral(a, b) == Approx(f.integral(a, b)).scale(1.0));
+         double const ca = std::max(-5.0, std::min(a, +5.0)) / sqrt(2.0);
+         double const cb = std::max(-5.0, std::min(b, +5.0)) / sqrt(2.0);
+         double const e  = sqrt(0.5 * M_PI) * (erf(cb) - erf(ca));
+         REQUIRE(fabs(md.integral(a, b) - e) < 1.0E-04);
+      }
+   }
+
+   // Move leaves mapping with new instance.
+   mapped_table mm(std::move(md));
+   REQUIRE(mm(0.0) == d(0.0));
+
+   REQUIRE_THROWS(mapped_table("no-such-table.bin"));
+   REQUIRE_THROWS(mapped_table("interpolant_test.txt"));
+
+   // Reject bad degree, which would otherwise corrupt size of each array.
+   uint32_t const bad[] = {4, 0xFFFFFFFF};
+   for (uint32_t const b : bad) {
+      write_table("dense_test.bin", d);
+      {
+         fstream fs("dense_test.bin", ios::in | ios::out | ios::binary);
+         fs.seekp(offsetof(table_header, degree));
+         fs.write(reinterpret_cast<char const *>(&b), sizeof(b));
+      }
+      REQUIRE_THROWS(mapped_table("dense_test.bin"));
+      remove("dense_test.bin");
+   }
+   write_table("sparse_test.bin", f);
+   {
+      uint32_t const b = 1;
+      fstream fs("sparse_test.bin", ios::in | ios::out | ios::binary);
+      fs.seekp(offsetof(table_header, degree));
+      fs.write(reinterpret_cast<char const *>(&b), sizeof(b));
+   }
+   REQUIRE_THROWS(mapped_table("sparse_test.bin"));
+   remove("sparse_test.bin");
+
+   // Reject rank past end of table, which would otherwise be used as offset.
+   write_table("sparse_test.bin", f);
+   {
+      uint64_t const n = f.size();
+      uint32_t const b = n + 1;
+      fstream fs("sparse_test.bin", ios::in | ios::out | ios::binary);
+      // Skip boundaries, centers, coefficients, integrals, keys, and rank 0.
+      fs.seekp(sizeof(table_header) + 8 * (3 * (n + 1) + 5 * n) + 4);
+      fs.write(reinterpret_cast<char const *>(&b), sizeof(b));
+   }
+   REQUIRE_THROWS(mapped_table("sparse_test.bin"));
+   remove("sparse_test.bin");
+}
+
+TEST_CASE("Verify reduced-precision dense table.", "[interpolant]")
+{
+   std::function<double(double)> g = [](double x) {
+      return exp(-0.5 * x * x);
+   };
+   auto const d = make_dense_interp<3>(g, -5.0, +5.0, 1.0E-07);
+   double     ef, eb;
+   auto const f = make_narrow_table<float>(d, ef, 1.0E-06);
+   auto const b = make_narrow_table<bfloat16>(d, eb);
+
+   REQUIRE(sizeof(f.f()[0]) == sizeof(d.f()[0]) / 2);
+   REQUIRE(sizeof(b.f()[0]) == sizeof(d.f()[0]) / 4);
+   REQUIRE(ef > 0.0);
+   REQUIRE(ef < 1.0E-06);
+   REQUIRE(eb > ef);
+   REQUIRE(eb < 1.0E-02);
+   vector<double> x;
+   for (double a = -5.2; a < 5.2; a += 0.0011) {
+      x.push_back(a);
+   }
+   vector<double> y(x.size());
+   f.val(x.data(), x.data() + x.size(), y.data());
+   for (unsigned j = 0; j < x.size(); ++j) {
+      REQUIRE(y[j] == f(x[j]));
+      REQUIRE(fabs(f(x[j]) - d(x[j])) <= ef * (1.0 + 1.0E-09) + 1.0E-15);
+      REQUIRE(fabs(b(x[j]) - d(x[j])) <= eb * (1.0 + 1.0E-09) + 1.0E-15);
+   }
+   REQUIRE(f(5.1) == 0.0);
+   REQUIRE(double(bfloat16(1.0)) == 1.0);
+   REQUIRE(double(bfloat16(-0.15625)) == -0.15625);
+   REQUIRE_THROWS(make_narrow_table<bfloat16>(d, eb, 1.0E-06));
+
+   // Policy for argument outside domain is kept.
+   dense_table<double, poly<3>, outside::clamp> const dc(
+         d.a_frst(), d.da(), d.f());
+   auto const fc = make_narrow_table<float>(dc, ef);
+   REQUIRE(fc(5.1) == fc(5.0));
+   REQUIRE(fc(5.0) == f(5.0));
+}
+
+TEST_CASE("Verify multi-output dense interpolant.", "[interpolant]")
+{
+   std::function<double(double)> g = [](double x) {
+      return exp(-0.5 * x * x);
+   };
+   std::function<double(double)> h = [](double x) { return sin(x); };
+   std::function<double(double)> k = [](double x) { return 1.0 + x * x; };
+   double const t  = 1.0E-06;
+   auto const   mt = make_multi_interp<3, 3>({{g, h, k}}, -5.0, +5.0, t);
+   auto const   dg = make_dense_interp<3>(g, -5.0, +5.0, t);
+
+   // Common grid is fine enough for the most demanding function.
+   REQUIRE(mt.f().size() >= dg.f().size());
+   REQUIRE(sizeof(mt.f()[0]) == 3 * sizeof(dg.f()[0]));
+   vector<double> x;
+   for (double a = -5.2; a < 5.2; a += 0.0013) {
+      x.push_back(a);
+   }
+   vector<array<double, 3>> y(x.size());
+   REQUIRE(mt.val(x.begin(), x.end(), y.begin()) == y.end());
+   for (unsigned j = 0; j < x.size(); ++j) {
+      array<double, 3> const v = mt(x[j]);
+      REQUIRE(y[j] == v);
+      if (x[j] < -5.0 || x[j] > 5.0) {
+         REQUIRE(v[0] == 0.0);
+         REQUIRE(v[1] == 0.0);
+         REQUIRE(v[2] == 0.0);
+      } else {
+         REQUIRE(fabs(v[0] - g(x[j])) <= 10 * t);
+         REQUIRE(fabs(v[1] - h(x[j])) <= 10 * t);
+         REQUIRE(fabs(v[2] - k(x[j])) <= 26 * 10 * t);
+      }
+   }
+   poly<3> const p = mt.f()[7].out(1);
+   REQUIRE(p(0.01) == mt.f()[7](0.01)[1]);
+}
+
+TEST_CASE("Verify Chebyshev interpolant of function.", "[interpolant]")
+{
+   std::function<double(double)> g = [](double x) {
+      return exp(-0.5 * x * x);
+   };
+   double const t  = 1.0E-09;
+   auto const   c8 = make_cheb_interp<8>(g, -5.0, +5.0, t);
+   auto const   c4 = make_cheb_interp<4>(g, +5.0, -5.0, t, 16, 1);
+   auto const   d1 = make_dense_interp<1>(g, -5.0, +5.0, t);
+
+   REQUIRE(100 * c8.f().size() <= d1.f().size());
+   REQUIRE(10 * c4.f().size() <= d1.f().size());
+   REQUIRE(c8.a_frst() - 0.5 * c8.da() == Approx(-5.0));
+   REQUIRE(c8.a_last() + 0.5 * c8.da() == Approx(+5.0));
+   vector<double> x;
+   for (double a = -5.1; a <= 5.1; a += 0.00077) {
+      x.push_back(a);
+   }
+   vector<double> y(x.size());
+   REQUIRE(c8.val(x.data(), x.data() + x.size(), y.data()) ==
+           y.data() + y.size());
+   for (unsigned j = 0; j < x.size(); ++j) {
+      REQUIRE(y[j] == c8(x[j]));
+      if (x[j] < -5.0 || x[j] > 5.0) {
+         REQUIRE(y[j] == 0.0);
+      } else {
+         REQUIRE(fabs(y[j] - g(x[j])) <= 10 * t);
+         REQUIRE(fabs(c4(x[j]) - g(x[j])) <= 10 * t);
+      }
+   }
+
+   // A series of degree D reproduces a polynomial of degree D.
+   double const v[] = {2.0, 3.0, 4.0};
+   double       n[3];
+   for (unsigned k = 0; k < 3; ++k) {
+      double const u = cheb<2>::node(k);
+      n[k]           = v[0] + v[1] * u + v[2] * u * u;
+   }
+   cheb<2> const p = cheb<2>::fit(n, 2.0);
+   REQUIRE(p(0.0) == Approx(2.0));
+   REQUIRE(p(0.5) == Approx(2.0 + 1.5 + 1.0));
+   REQUIRE(p(-1.0) == Approx(2.0 - 3.0 + 4.0));
+   REQUIRE_THROWS(make_cheb_interp<8>(g, -5.0, +5.0, 0.0));
+}
+
+TEST_CASE("Verify logarithmically warped table.", "[interpolant]")
+{
+   // Power law with a resonance, over eight decades.
+   std::function<double(double)> g = [](double x) {
+      return pow(x, -1.5) * (1.0 + 0.5 / (1.0 + pow(log(x / 30.0), 2)));
+   };
+   double const t  = 1.0E-06;
+   double const aa = 1.0E-03;
+   double const bb = 1.0E+05;
+   auto const   fw = make_warped_table(g, aa, bb, t, true);
+   auto const   lw = make_warped_table(g, aa, bb, t, true, log_warp());
+
+   REQUIRE(fw.f().size() < 4096);
+   REQUIRE(fw.bounds().front() == Approx(1.0E-03));
+   REQUIRE(fw.bounds().back() == Approx(1.0E+05));
+   fast_log2_warp const w;
+   REQUIRE(w(1.0) == 0.0);
+   REQUIRE(w(3.0) == 1.5);
+   REQUIRE(w(0.75) == -0.5);
+   REQUIRE(w.inv(w(12345.678)) == Approx(12345.678).epsilon(1.0E-12));
+   vector<double> x;
+   for (double a = 5.0E-04; a < 2.0E+05; a *= 1.0011) {
+      x.push_back(a);
+   }
+   x.push_back(-1.0);
+   vector<double> y(x.size());
+   REQUIRE(fw.val(x.begin(), x.end(), y.begin()) == y.end());
+   for (unsigned j = 0; j < x.size(); ++j) {
+      REQUIRE(y[j] == fw(x[j]));
+      if (x[j] < fw.bounds().front() || x[j] > fw.bounds().back()) {
+         REQUIRE(y[j] == 0.0);
+      } else {
+         REQUIRE(fabs(y[j] / g(x[j]) - 1.0) < 10 * t);
+      }
+      if (x[j] >= lw.bounds().front() && x[j] <= lw.bounds().back()) {
+         REQUIRE(fabs(lw(x[j]) / g(x[j]) - 1.0) < 10 * t);
+      }
+   }
+   REQUIRE_THROWS(make_warped_table(g, 1.0, 0.5, t));
+   REQUIRE_THROWS(make_warped_table(g, 0.0, 1.0, t));
+   REQUIRE_THROWS(make_warped_table(g, -1.0, 1.0, t, false, log_warp()));
+   REQUIRE_THROWS(make_warped_table(g, 1.0E-03, 1.0E+05, t, true,
+                                    fast_log2_warp(), 16, 64));
+
+   // Each end of the domain is in the table, whatever the round-off in the
+   // transform and its inverse.
+   std::function<double(double)> r = [](double x) { return sqrt(x); };
+   double const ends[][2] = {{0.37, 12345.678}, {0.1, 0.3}, {1.7, 3.1}};
+   for (auto const &e : ends) {
+      auto const tr = make_warped_table(r, e[0], e[1], t, true);
+      REQUIRE(tr.bounds().front() == e[0]);
+      REQUIRE(tr.bounds().back() == e[1]);
+      REQUIRE(fabs(tr(e[0]) / sqrt(e[0]) - 1.0) < 10 * t);
+      REQUIRE(fabs(tr(e[1]) / sqrt(e[1]) - 1.0) < 10 * t);
+   }
+}
+
+TEST_CASE("Verify regular-grid table of several arguments.", "[interpolant]")
+{
+   auto const bl = [](double x, double y) {
+      return 1 + 2 * x + 3 * y + x * y;
+   };
+   auto const bq = [](double x, double y) {
+      return x * x - x * y + 2 * y * y;
+   };
+   auto const t1 = make_grid_table<1>(bl, make_tuple(0.0, -1.0),
+                                      make_tuple(0.1, 0.1), {{11, 21}});
+   auto const t3 = make_grid_table<3>(bq, make_tuple(0.0, -1.0),
+                                      make_tuple(0.1, 0.1), {{11, 21}});
+
+   REQUIRE(t1.v().size() == 11 * 21);
+   REQUIRE(t1.strides()[0] == 21);
+   REQUIRE(t1.strides()[1] == 1);
+   REQUIRE(get<1>(t1.last()) == Approx(1.0));
+   for (double x = 0.0; x <= 1.0; x += 0.037) {
+      for (double y = -1.0; y <= 1.0; y += 0.043) {
+         REQUIRE(t1(x, y) == Approx(bl(x, y)));
+         REQUIRE(t3(x, y) == Approx(bq(x, y)).scale(1.0));
+      }
+   }
+   REQUIRE(t1(1.0, 1.0) == Approx(bl(1.0, 1.0)));
+   REQUIRE(t3(0.0, -1.0) == Approx(bq(0.0, -1.0)));
+   REQUIRE(t1(-0.01, 0.0) == 0.0);
+   REQUIRE(t1(0.5, 1.01) == 0.0);
+   REQUIRE(t3(1.01, 0.0) == 0.0);
+
+   // Trilinear interpolation on the smallest grid.
+   auto const t2 = make_grid_table<1>(
+         [](double x, double y, double z) { return x * y * z; },
+         make_tuple(0.0, 0.0, 0.0), make_tuple(2.0, 2.0, 2.0), {{2, 2, 2}});
+   REQUIRE(t2(1.0, 0.5, 1.5) == Approx(0.75));
+   REQUIRE(t2(2.0, 2.0, 2.0) == Approx(8.0));
+
+   // Smooth function, bicubic.
+   auto const g  = [](double x, double y) { return sin(x) * cos(y); };
+   auto const tg = make_grid_table<3>(g, make_tuple(0.0, 0.0),
+                                      make_tuple(0.01, 0.02), {{101, 101}});
+   vector<tuple<double, double>> a;
+   for (double x = -0.05; x < 1.05; x += 0.0097) {
+      for (double y = -0.05; y < 2.05; y += 0.0193) {
+         a.push_back(make_tuple(x, y));
+      }
+   }
+   vector<double> v(a.size());
+   REQUIRE(tg.val(a.begin(), a.end(), v.begin()) == v.end());
+   for (unsigned j = 0; j < a.size(); ++j) {
+      double const x = get<0>(a[j]);
+      double const y = get<1>(a[j]);
+      REQUIRE(v[j] == tg(x, y));
+      if (x < 0.0 || x > 1.0 || y < 0.0 || y > 2.0) {
+         REQUIRE(v[j] == 0.0);
+      } else {
+         REQUIRE(fabs(v[j] - g(x, y)) < 1.0E-06);
+      }
+   }
+
+   using table = grid_table<3, double, double, double>;
+   REQUIRE_THROWS(table(make_tuple(0.0, 0.0), make_tuple(1.0, 1.0),
+                        {{3, 3}}, vector<double>(8)));
+   REQUIRE_THROWS(table(make_tuple(0.0, 0.0), make_tuple(1.0, 1.0),
+                        {{2, 4}}, vector<double>(8)));
+   REQUIRE_THROWS(table(make_tuple(0.0, 0.0), make_tuple(1.0, 0.0),
+                        {{3, 3}}, vector<double>(9)));
+}
+
+TEST_CASE("Verify regular-grid table with units.", "[interpolant]")
+{
+   using time = num::time;
+   auto const t = make_grid_table<1>(
+         [](length x, time y) { return x * y; }, make_tuple(0.0 * m, 0.0 * s),
+         make_tuple(1.0 * m, 1.0 * s), {{3, 3}});
+   REQUIRE(t(1.5 * m, 0.5 * s) / (m * s) == Approx(0.75));
+   REQUIRE(t(2.5 * m, 0.5 * s) / (m * s) == 0.0);
+
+   grid_table<1, double, dyndim> const d(
+         make_tuple(dyndim(0 * nm)), make_tuple(dyndim(100 * nm)), {{3}},
+         {0.0, 1.0, 4.0});
+   REQUIRE(d(150 * nm) == Approx(2.5));
+   REQUIRE(d(-1 * nm) == 0.0);
+   REQUIRE_THROWS(d(1.0 * s));
+}
+
 TEST_CASE("Verify product of interpolants.", "[interpolant]")
 {
    ilist<double, double> list1 = {{0.00, 0.00}, {0.50, 0.25}, {1.00, 1.00}};
@@ -76,6 +821,35 @@ TEST_CASE("Verify product of interpolants.", "[interpolant]")
    REQUIRE(j4(2.00) == 0.0);
 }
 
+TEST_CASE("Verify fused combination of interpolants.", "[interpolant]")
+{
+   ilist<double, double> list1 = {{0.00, 0.00}, {0.50, 0.25}, {1.00, 1.00}};
+   ilist<double, double> list2 = {{0.25, 2.00}, {0.75, 1.00}, {1.25, 0.00}};
+   ilist<double, double> list3 = {{0.10, 1.00}, {0.30, 3.00}, {0.90, 2.00}};
+   ilist<double, double> list4 = {{-1.0, 0.00}, {0.60, 0.50}, {2.00, 1.00}};
+
+   using table  = sparse_table<double>;
+   auto const a = make_linear_interp(list1);
+   auto const b = make_linear_interp(list2);
+   auto const c = make_linear_interp(list3);
+   auto const d = make_linear_interp(list4);
+
+   auto const f = table::fuse({a, b, c, d}, [](vector<ex> const &g) {
+      return g[0] * g[1] + g[2] * g[3];
+   });
+   auto const h = a * b + c * d;
+
+   REQUIRE(f.dat().size() == 5);
+   REQUIRE(f.has_pol());
+   for (double x = -0.5; x < 1.5; x += 0.01) {
+      REQUIRE(f.val(x) == Approx(h.val(x)));
+   }
+   REQUIRE(dbl(f.integral()) == Approx(dbl(h.integral())));
+   REQUIRE(table::fuse({}, [](vector<ex> const &) { return ex(0); })
+                 .dat()
+                 .size() == 0);
+}
+
 TEST_CASE("Verify quotient of interpolants.", "[interpolant]")
 {
    ilist<double, double> list1 = {{0.00, 0.00}, {0.50, 0.25}, {1.00, 1.00}};